@@ -0,0 +1,124 @@
+#include "pid-bank.h"
+#include <stdlib.h>
+
+/**
+ * @brief allocate a bank of count pid handlers with the default configuration
+ * 
+ * @param bank 
+ * @param count         number of pid handlers
+ * @return pid_result_t 
+ */
+pid_result_t pid_bank_create(pid_bank_t *bank, size_t count)
+{
+    PID_RETURN_IF_NULL(bank);
+
+    bank->pid = (pid_handle_t *)calloc(count, sizeof(pid_handle_t));
+    bank->count = 0;
+    bank->computed = 0;
+    bank->stats = NULL;
+    if (!bank->pid)
+    {
+        PID_LOG("can not allocate %u pid handlers\n", (unsigned)count);
+        return PID_ERR_MEM;
+    }
+
+    bank->count = count;
+    for (size_t i = 0; i < count; i++)
+    {
+        pid_set_default(&bank->pid[i]);
+    }
+    return PID_OK;
+}
+
+/**
+ * @brief release the pid handlers of a bank
+ * 
+ * @param bank 
+ */
+void pid_bank_destroy(pid_bank_t *bank)
+{
+    if (bank)
+    {
+        free(bank->pid);
+        free(bank->stats);
+        bank->pid = NULL;
+        bank->stats = NULL;
+        bank->count = 0;
+    }
+}
+
+/**
+ * @brief allocate and attach the statistics blocks of the bank
+ * 
+ * @param bank 
+ * @param band          zero crossing hysteresis, see pid_stats_init
+ * @return pid_result_t PID_ERROR for an empty bank
+ */
+pid_result_t pid_bank_enable_stats(pid_bank_t *bank, float band)
+{
+    PID_RETURN_IF_NULL(bank);
+    if (bank->count == 0)
+        return PID_ERROR;
+
+    if (!bank->stats)
+        bank->stats = (pid_stats_t *)malloc(bank->count * sizeof(pid_stats_t));
+    if (!bank->stats)
+    {
+        PID_LOG("can not allocate %u statistics blocks\n", (unsigned)bank->count);
+        return PID_ERR_MEM;
+    }
+
+    for (size_t i = 0; i < bank->count; i++)
+    {
+        if (pid_stats_init(&bank->stats[i], band) != PID_OK)
+            return PID_ERROR;
+    }
+    return PID_OK;
+}
+
+/**
+ * @brief run pid_on_processing for every pid handler of the bank
+ * 
+ * @param bank 
+ * @param pv            array of bank->count process values
+ * @return pid_result_t PID_OK, or the last error of the bank
+ */
+pid_result_t pid_bank_on_processing(pid_bank_t *bank, const float *pv)
+{
+    pid_result_t err = PID_OK, ret = PID_OK;
+
+    PID_RETURN_IF_NULL(bank);
+    PID_RETURN_IF_NULL(pv);
+
+    size_t computed = 0;
+
+    for (size_t i = 0; i < bank->count; i++)
+    {
+        ret = pid_on_processing(&bank->pid[i], pv[i]);
+        if (ret != PID_OK)
+        {
+            // the handler state is not a new sample, it is not accounted
+            err = ret;
+            continue;
+        }
+        if (bank->pid[i].control.event.computed)
+            computed++;
+        if (bank->stats)
+            pid_stats_update(&bank->stats[i], &bank->pid[i]);
+    }
+    bank->computed = computed;
+    return err;
+}
+
+/**
+ * @brief convert the outputs of the bank to dac codes in one pass
+ * 
+ * @param bank 
+ * @param dac           array of bank->count dac codes, eg: a dma buffer
+ * @return pid_result_t 
+ */
+pid_result_t pid_bank_get_output_codes(pid_bank_t *bank, uint16_t *dac)
+{
+    PID_RETURN_IF_NULL(bank);
+    return io_convert_outputs(bank->pid, bank->count, dac);
+}
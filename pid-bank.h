@@ -0,0 +1,83 @@
+/**
+ * @file pid-bank.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief 
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+#ifndef __PID_BANK_H__
+#define __PID_BANK_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include "pid.h"
+#include "pid-stats.h"
+
+    /**
+     * @brief a bank of pid controllers, stored in one contiguous block so
+     * that the whole fleet can be processed in a single pass
+     */
+    typedef struct _pid_bank_t
+    {
+        pid_handle_t *pid; // array of count pid handlers
+        size_t count;      // number of pid handlers in the bank
+        size_t computed;   // number of pid handlers computed on the last tick
+        pid_stats_t *stats; // optional, array of count statistics blocks updated on each tick
+    } pid_bank_t;
+
+    /**
+     * @brief allocate a bank of count pid handlers with the default configuration
+     * 
+     * @param bank 
+     * @param count         number of pid handlers
+     * @return pid_result_t 
+     */
+    pid_result_t pid_bank_create(pid_bank_t *bank, size_t count);
+
+    /**
+     * @brief release the pid handlers of a bank
+     * 
+     * @param bank 
+     */
+    void pid_bank_destroy(pid_bank_t *bank);
+
+    /**
+     * @brief allocate and attach the statistics blocks of the bank
+     * 
+     * @param bank 
+     * @param band          zero crossing hysteresis, see pid_stats_init
+     * @return pid_result_t PID_ERROR for an empty bank
+     */
+    pid_result_t pid_bank_enable_stats(pid_bank_t *bank, float band);
+
+    /**
+     * @brief run pid_on_processing for every pid handler of the bank
+     * bank->computed is updated with the number of handlers which were not
+     * skipped by the event driven processing, and the statistics if enabled
+     * 
+     * @param bank 
+     * @param pv            array of bank->count process values
+     * @return pid_result_t PID_OK, or the last error of the bank
+     */
+    pid_result_t pid_bank_on_processing(pid_bank_t *bank, const float *pv);
+
+    /**
+     * @brief convert the outputs of the bank to dac codes in one pass
+     * 
+     * @param bank 
+     * @param dac           array of bank->count dac codes, eg: a dma buffer
+     * @return pid_result_t 
+     */
+    pid_result_t pid_bank_get_output_codes(pid_bank_t *bank, uint16_t *dac);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __PID_BANK_H__
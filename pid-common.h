@@ -20,17 +20,13 @@ extern "C"
 #include <stdio.h>
 #include <stdint.h>
 
-#define USE_DEBUG
+#include "pid-log.h"
 
-#ifdef USE_DEBUG
-#define __FILENAME__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : strrchr(__FILE__, '\\') ? strrchr(__FILE__, '\\') + 1 \
-                                                                                                    : __FILE__)
-#define PID_LOG(...)                                                    \
-    printf("[PID_LOG] --> file %s, line %d: ", __FILENAME__, __LINE__); \
-    printf(__VA_ARGS__)
-#else
-#define PID_LOG(...)
-#endif
+/**
+ * @brief PID_LOG is an error level message, see pid-log.h for the other levels.
+ * The messages are stored in a ring and formatted by pid_log_drain()
+ */
+#define PID_LOG(...) PID_LOGE(__VA_ARGS__)
 
 #define MAX_OUT_PERCENT 110.0F
 #define MIN_OUT_PERCENT 0.0F
@@ -47,6 +43,7 @@ extern "C"
 
     typedef enum _pid_result_t
     {
+        PID_ERR_SNAPSHOT = -7,
         PID_ERR_LIMIT = -6,
         PID_ERR_GAIN = -5,
         PID_ERR_S = -4,
@@ -67,6 +64,7 @@ extern "C"
         PID_INIT_PARA = 0x20,
         PID_INIT_Bx = 0x40,
         PID_INIT_OUTPUT_CTRL = 0x80,
+        PID_INIT_DT = 0x100, // control.dt_coeff is valid, not required by pid_on_processing
     } pid_init_flag_e;
 
 #define PID_INIT_ALL ((uint32_t)(PID_INIT_TYPE | PID_INIT_PV_MIN_MAX | PID_INIT_CV_MIN_MAX | PID_INIT_CV_IO | \
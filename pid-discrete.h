@@ -0,0 +1,215 @@
+/**
+ * @file pid-discrete.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief discretization of the pid controller
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * Every method is written as
+ *
+ *   u(k) = a1.u(k-1) + a2.u(k-2) + b2.e(k) + b1.e(k-1) + b0.e(k-2)
+ *
+ * "Tustin" (a1 = 0, a2 = 1)
+ *   b2 = Kp + Ki.T/2 + 2.Kd/T
+ *   b1 = Ki.T - 4.Kd/T
+ *   b0 = -Kp + Ki.T/2 + 2.Kd/T
+ *
+ * "Backward Euler" (a1 = 1, a2 = 0)
+ *   b2 = Kp + Ki.T + Kd/T
+ *   b1 = -(Kp + 2.Kd/T)
+ *   b0 = Kd/T
+ *
+ * "Forward Euler" (a1 = 1, a2 = 0)
+ *   b2 = Kp + Kd/T
+ *   b1 = -Kp + Ki.T - 2.Kd/T
+ *   b0 = Kd/T
+ *
+ * "Filtered derivative" Kd.s / (Tf.s + 1), backward Euler
+ * (al = Tf/(Tf + T), be = Kd/(Tf + T), a1 = 1 + al, a2 = -al)
+ *   b2 = Kp + Ki.T + be
+ *   b1 = -Kp(1 + al) - Ki.T.al - 2.be
+ *   b0 = Kp.al + be
+ *
+ * Variable sample time (pid_on_processing_dt), dt = dt(k), dt1 = dt(k-1):
+ * the derivative difference of the previous sample uses its own interval,
+ * so the terms of e(k-2) only depend on dt1.
+ *
+ * "Tustin"
+ *   b2 = Kp + Ki.dt/2 + 2.Kd/dt
+ *   b1 = Ki.(dt + dt1)/2 - 2.Kd/dt - 2.Kd/dt1
+ *   b0 = -Kp + Ki.dt1/2 + 2.Kd/dt1
+ *
+ * "Backward Euler"
+ *   b2 = Kp + Ki.dt + Kd/dt
+ *   b1 = -Kp - Kd/dt - Kd/dt1
+ *   b0 = Kd/dt1
+ *
+ * "Forward Euler"
+ *   b2 = Kp + Kd/dt
+ *   b1 = -Kp + Ki.dt - Kd/dt - Kd/dt1
+ *   b0 = Kd/dt1
+ *
+ * "Filtered derivative": the coefficients above with T = dt, the filter
+ * state is not kept apart so the pole of the previous interval is not used.
+ *
+ * With dt = dt1 = T every method gives the fixed rate coefficients.
+ *
+ * pid_discrete_coeff() is constexpr in C++: with constant gains and sample
+ * time the coefficients are computed by the compiler and loaded with
+ * pid_set_coeff(), eg:
+ *
+ *   constexpr pid_coeff_t c = pid_discrete_coeff(PID_DISCRETE_TUSTIN, 2.0f, 0.5f, 0.01f, 0, 0.01f);
+ *   pid_set_coeff(pid, &c);
+ */
+#ifndef __PID_DISCRETE_H__
+#define __PID_DISCRETE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pid-typedef.h"
+
+#ifdef __cplusplus
+#define PID_CONSTEXPR static constexpr
+#else
+#define PID_CONSTEXPR static inline
+#endif
+
+    typedef struct _pid_coeff_t
+    {
+        float b0;
+        float b1;
+        float b2;
+        float a1;
+        float a2;
+    } pid_coeff_t;
+
+    /**
+     * @brief coefficients of the difference equation
+     * 
+     * @param method        discretization method
+     * @param kp 
+     * @param ki 
+     * @param kd 
+     * @param tf            derivative filter time constant, PID_DISCRETE_FILTERED_D only
+     * @param sample_time   sample time in second, > 0
+     * @return pid_coeff_t  all zero for an unknown method
+     */
+    PID_CONSTEXPR pid_coeff_t pid_discrete_coeff(pid_discrete_method_e method, float kp, float ki, float kd,
+                                                 float tf, float sample_time)
+    {
+        pid_coeff_t c = {0, 0, 0, 0, 0};
+        const float T = sample_time;
+        float al = 0, be = 0;
+
+        switch (method)
+        {
+        case PID_DISCRETE_TUSTIN:
+            c.b0 = -kp + ki * T / 2.0 + 2.0 * kd / T;
+            c.b1 = ki * T - 4.0 * kd / T;
+            c.b2 = kp + ki * T / 2.0 + 2.0 * kd / T;
+            c.a1 = 0;
+            c.a2 = 1;
+            break;
+
+        case PID_DISCRETE_BACKWARD_EULER:
+            c.b0 = kd / T;
+            c.b1 = -(kp + 2.0 * kd / T);
+            c.b2 = kp + ki * T + kd / T;
+            c.a1 = 1;
+            c.a2 = 0;
+            break;
+
+        case PID_DISCRETE_FORWARD_EULER:
+            c.b0 = kd / T;
+            c.b1 = -kp + ki * T - 2.0 * kd / T;
+            c.b2 = kp + kd / T;
+            c.a1 = 1;
+            c.a2 = 0;
+            break;
+
+        case PID_DISCRETE_FILTERED_D:
+            al = tf / (tf + T);
+            be = kd / (tf + T);
+            c.b0 = kp * al + be;
+            c.b1 = -kp * (1 + al) - ki * T * al - 2.0 * be;
+            c.b2 = kp + ki * T + be;
+            c.a1 = 1 + al;
+            c.a2 = -al;
+            break;
+
+        default:
+            break;
+        }
+        return c;
+    }
+
+    /**
+     * @brief variable sample time coefficients, see pid_dt_coeff_t
+     * 
+     * @param method        discretization method, all zero for PID_DISCRETE_FILTERED_D
+     *                      whose coefficients are computed on each sample
+     * @param kp 
+     * @param ki 
+     * @param kd 
+     * @return pid_dt_coeff_t 
+     */
+    PID_CONSTEXPR pid_dt_coeff_t pid_discrete_dt_coeff(pid_discrete_method_e method, float kp, float ki, float kd)
+    {
+        pid_dt_coeff_t c = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, 0, 0};
+
+        switch (method)
+        {
+        case PID_DISCRETE_TUSTIN:
+            c.c[0] = -kp;
+            c.t1[0] = ki / 2.0f;
+            c.r1[0] = 2.0f * kd;
+            c.t[1] = ki / 2.0f;
+            c.t1[1] = ki / 2.0f;
+            c.r[1] = -2.0f * kd;
+            c.r1[1] = -2.0f * kd;
+            c.c[2] = kp;
+            c.t[2] = ki / 2.0f;
+            c.r[2] = 2.0f * kd;
+            c.a1 = 0;
+            c.a2 = 1;
+            break;
+
+        case PID_DISCRETE_BACKWARD_EULER:
+            c.r1[0] = kd;
+            c.c[1] = -kp;
+            c.r[1] = -kd;
+            c.r1[1] = -kd;
+            c.c[2] = kp;
+            c.t[2] = ki;
+            c.r[2] = kd;
+            c.a1 = 1;
+            c.a2 = 0;
+            break;
+
+        case PID_DISCRETE_FORWARD_EULER:
+            c.r1[0] = kd;
+            c.c[1] = -kp;
+            c.t[1] = ki;
+            c.r[1] = -kd;
+            c.r1[1] = -kd;
+            c.c[2] = kp;
+            c.r[2] = kd;
+            c.a1 = 1;
+            c.a2 = 0;
+            break;
+
+        default:
+            break;
+        }
+        return c;
+    }
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __PID_DISCRETE_H__
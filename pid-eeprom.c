@@ -1,10 +1,6 @@
 #include "pid-eeprom.h"
 
-static struct eeprom_func_t
-{
-    eeprom_read_f read_f;
-    eeprom_write_f write_f;
-} eeprom;
+static pid_eeprom_dev_t eeprom;
 
 /**
  * @brief set a eeprom read function 
@@ -27,47 +23,73 @@ void pid_set_eeprom_write_func(eeprom_write_f write_f)
 }
 
 /**
- * @brief eeprom write buffer
+ * @brief eeprom write buffer on a device
  * 
+ * @param dev 
  * @param base_addr 
  * @param buffer 
  * @param size 
  */
-void eeprom_write_data(uint32_t base_addr, uint8_t *buffer, size_t size)
+void eeprom_dev_write_data(const pid_eeprom_dev_t *dev, uint32_t base_addr, const uint8_t *buffer, size_t size)
 {
-    if (buffer)
+    if (dev && buffer)
     {
-        if (eeprom.write_f)
+        if (dev->write_f)
         {
             for (size_t i = 0; i < size; i++)
             {
-                eeprom.write_f(base_addr + i, buffer[i]);
+                dev->write_f(base_addr + i, buffer[i]);
             }
         }
     }
 }
 
 /**
- * @brief eeprom read buffer
+ * @brief eeprom read buffer from a device
  * 
+ * @param dev 
  * @param base_addr 
  * @param buffer 
  * @param size 
  */
-void eeprom_read_data(uint32_t base_addr, uint8_t *buffer, size_t size)
+void eeprom_dev_read_data(const pid_eeprom_dev_t *dev, uint32_t base_addr, uint8_t *buffer, size_t size)
 {
-    if (buffer)
+    if (dev && buffer)
     {
-        if (eeprom.read_f)
+        if (dev->read_f)
         {
             for (size_t i = 0; i < size; i++)
             {
-                buffer[i] = eeprom.read_f(i + base_addr);
+                buffer[i] = dev->read_f(i + base_addr);
             }
         }
     }
 }
 
+/**
+ * @brief eeprom write buffer
+ * 
+ * @param base_addr 
+ * @param buffer 
+ * @param size 
+ */
+void eeprom_write_data(uint32_t base_addr, uint8_t *buffer, size_t size)
+{
+    eeprom_dev_write_data(&eeprom, base_addr, buffer, size);
+}
+
+/**
+ * @brief eeprom read buffer
+ * 
+ * @param base_addr 
+ * @param buffer 
+ * @param size 
+ */
+void eeprom_read_data(uint32_t base_addr, uint8_t *buffer, size_t size)
+{
+    eeprom_dev_read_data(&eeprom, base_addr, buffer, size);
+}
+
 /**
  * @brief pid save data to eeprom
  * 
@@ -88,4 +110,10 @@ void pid_save_data(uint32_t base_addr, pid_handle_t* pid)
 void pid_read_data(uint32_t base_addr, pid_handle_t* pid)
 {
     eeprom_read_data(base_addr, (uint8_t*)pid, sizeof(pid_handle_t));
+    // the stored step function pointer is not valid anymore
+    if (pid)
+    {
+        pid->armed.step = NULL;
+        pid->armed.block = NULL;
+    }
 }
\ No newline at end of file
@@ -21,6 +21,36 @@ extern "C"
     typedef void (*eeprom_write_f)(uint32_t, uint8_t);
     typedef uint8_t (*eeprom_read_f)(uint32_t);
 
+    /**
+     * @brief one eeprom device, the functions without a device argument use
+     * the process wide default device
+     */
+    typedef struct _pid_eeprom_dev_t
+    {
+        eeprom_read_f read_f;
+        eeprom_write_f write_f;
+    } pid_eeprom_dev_t;
+
+    /**
+     * @brief eeprom write buffer on a device
+     * 
+     * @param dev 
+     * @param base_addr 
+     * @param buffer 
+     * @param size 
+     */
+    void eeprom_dev_write_data(const pid_eeprom_dev_t *dev, uint32_t base_addr, const uint8_t *buffer, size_t size);
+
+    /**
+     * @brief eeprom read buffer from a device
+     * 
+     * @param dev 
+     * @param base_addr 
+     * @param buffer 
+     * @param size 
+     */
+    void eeprom_dev_read_data(const pid_eeprom_dev_t *dev, uint32_t base_addr, uint8_t *buffer, size_t size);
+
     /**
      * @brief set a eeprom read function 
      * 
@@ -0,0 +1,289 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "pid-ingest.h"
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @brief allocate count channels, policy PID_INGEST_HOLD
+ * 
+ * @param in 
+ * @param count         number of channels
+ * @param max_age_us    default age above which a sample is stale
+ * @return pid_result_t 
+ */
+pid_result_t pid_ingest_create(pid_ingest_t *in, size_t count, uint32_t max_age_us)
+{
+    PID_RETURN_IF_NULL(in);
+    if (!count || (max_age_us > (uint32_t)INT32_MAX))
+        return PID_ERROR;
+
+    in->reg = (pid_ingest_register_t *)calloc(count, sizeof(pid_ingest_register_t));
+    in->channel = (pid_ingest_channel_t *)calloc(count, sizeof(pid_ingest_channel_t));
+    in->count = 0;
+    if (!in->reg || !in->channel)
+    {
+        PID_LOG("can not allocate %u ingest channels\n", (unsigned)count);
+        pid_ingest_destroy(in);
+        return PID_ERR_MEM;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        in->channel[i].max_age_us = max_age_us;
+        in->channel[i].policy = PID_INGEST_HOLD;
+        in->channel[i].state = PID_INGEST_EMPTY;
+    }
+    in->count = count;
+    return PID_OK;
+}
+
+/**
+ * @brief release the channels
+ * 
+ * @param in 
+ */
+void pid_ingest_destroy(pid_ingest_t *in)
+{
+    if (in)
+    {
+        free(in->reg);
+        free(in->channel);
+        in->reg = NULL;
+        in->channel = NULL;
+        in->count = 0;
+    }
+}
+
+/**
+ * @brief configure the stale handling of a channel (control thread)
+ * 
+ * @param in 
+ * @param channel 
+ * @param max_age_us    age above which a sample is stale
+ * @param policy 
+ * @param failsafe      output of PID_INGEST_FAILSAFE
+ * @return pid_result_t 
+ */
+pid_result_t pid_ingest_set_policy(pid_ingest_t *in, size_t channel, uint32_t max_age_us,
+                                   pid_ingest_policy_e policy, float failsafe)
+{
+    PID_RETURN_IF_NULL(in);
+    if ((channel >= in->count) || (max_age_us > (uint32_t)INT32_MAX) ||
+        (policy < PID_INGEST_HOLD) || (policy >= PID_INGEST_POLICY_MAX))
+        return PID_ERROR;
+
+    in->channel[channel].max_age_us = max_age_us;
+    in->channel[channel].policy = policy;
+    in->channel[channel].failsafe = failsafe;
+    return PID_OK;
+}
+
+/**
+ * @brief monotonic time in microseconds, truncated to 32 bits
+ * 
+ * @return uint32_t 
+ */
+uint32_t pid_ingest_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL);
+}
+
+/**
+ * @brief store a sample, lock free, any thread
+ * 
+ * @param in 
+ * @param channel 
+ * @param pv 
+ * @param time_us       acquisition time, pid_ingest_now_us() clock
+ * @return pid_result_t PID_ERROR if the register holds a newer sample
+ */
+pid_result_t pid_ingest_write(pid_ingest_t *in, size_t channel, float pv, uint32_t time_us)
+{
+    pid_ingest_register_t *reg;
+    uint64_t old, latest;
+    uint32_t bits;
+
+    PID_RETURN_IF_NULL(in);
+    if (channel >= in->count)
+        return PID_ERROR;
+
+    // 0 marks an empty register
+    if (time_us == 0)
+        time_us = 1;
+    memcpy(&bits, &pv, sizeof(bits));
+    latest = ((uint64_t)time_us << 32) | bits;
+
+    reg = &in->reg[channel];
+    old = __atomic_load_n(&reg->latest, __ATOMIC_RELAXED);
+    do
+    {
+        if (old && ((int32_t)(time_us - (uint32_t)(old >> 32)) < 0))
+        {
+            __atomic_add_fetch(&reg->rejected, 1, __ATOMIC_RELAXED);
+            return PID_ERROR;
+        }
+    } while (!__atomic_compare_exchange_n(&reg->latest, &old, latest, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    return PID_OK;
+}
+
+/**
+ * @brief read the latest sample of a channel
+ * 
+ * @param in 
+ * @param channel 
+ * @param pv 
+ * @param time_us       timestamp of the sample, can be NULL
+ * @return pid_result_t PID_ERROR if the channel was never written
+ */
+pid_result_t pid_ingest_read(const pid_ingest_t *in, size_t channel, float *pv, uint32_t *time_us)
+{
+    uint64_t latest;
+    uint32_t bits;
+
+    PID_RETURN_IF_NULL(in);
+    PID_RETURN_IF_NULL(pv);
+    if (channel >= in->count)
+        return PID_ERROR;
+
+    latest = __atomic_load_n(&in->reg[channel].latest, __ATOMIC_ACQUIRE);
+    if (!latest)
+        return PID_ERROR;
+
+    bits = (uint32_t)latest;
+    memcpy(pv, &bits, sizeof(bits));
+    if (time_us)
+        *time_us = (uint32_t)(latest >> 32);
+    return PID_OK;
+}
+
+/**
+ * @brief hold the output, the history is kept flat as in the event driven
+ * mode so that the next computed sample starts from the held output
+ * 
+ * @param pid 
+ */
+static void pid_ingest_hold(pid_handle_t *pid)
+{
+    pid->control.err[2] = pid->control.err[1] = pid->control.err[0];
+    pid->control.cv.buff[2] = pid->control.cv.buff[1] = pid->control.cv.buff[0];
+    pid->control.event.computed = false;
+}
+
+/**
+ * @brief run one tick of pid with the latest sample of a channel, or apply
+ * the stale policy (control thread)
+ * 
+ * @param in 
+ * @param channel 
+ * @param pid 
+ * @param now_us        tick time, pid_ingest_now_us() clock
+ * @return pid_ingest_state_e
+ */
+pid_ingest_state_e pid_ingest_apply(pid_ingest_t *in, size_t channel, pid_handle_t *pid, uint32_t now_us)
+{
+    pid_ingest_channel_t *ch = &in->channel[channel];
+    uint64_t latest = __atomic_load_n(&in->reg[channel].latest, __ATOMIC_ACQUIRE);
+    uint32_t time = (uint32_t)(latest >> 32), bits = (uint32_t)latest;
+    float pv;
+
+    if (ch->state == PID_INGEST_LATCHED)
+    {
+        ch->stale_ticks++;
+        pid_ingest_hold(pid);
+        return PID_INGEST_LATCHED;
+    }
+
+    // nothing received yet: hold without applying the policy
+    if (!latest)
+    {
+        pid_ingest_hold(pid);
+        return PID_INGEST_EMPTY;
+    }
+
+    // a sample which was already stale does not become fresh again when
+    // the 32 bit age wraps, only a new sample clears the stale state
+    if (((ch->state != PID_INGEST_STALE) || (time != ch->last_time)) &&
+        ((int32_t)(now_us - time) <= (int32_t)ch->max_age_us))
+    {
+        memcpy(&pv, &bits, sizeof(pv));
+        ch->last_time = time;
+        ch->state = PID_INGEST_FRESH;
+        pid_on_processing(pid, pv);
+        return PID_INGEST_FRESH;
+    }
+
+    if (ch->state != PID_INGEST_STALE)
+    {
+        ch->stale_events++;
+        ch->last_time = time;
+        PID_LOGW("pv channel %u is stale, policy %d\n", (unsigned)channel, (int)ch->policy);
+    }
+    ch->stale_ticks++;
+    ch->state = PID_INGEST_STALE;
+
+    switch (ch->policy)
+    {
+    case PID_INGEST_FAILSAFE:
+        pid->control.cv.buff[0] = ch->failsafe;
+        break;
+    case PID_INGEST_MANUAL:
+        ch->mode = pid->control.operation_mode;
+        pid_set_operation_mode(pid, PID_MANUAL_MODE);
+        ch->state = PID_INGEST_LATCHED;
+        break;
+    default:
+        break;
+    }
+    pid_ingest_hold(pid);
+    return (pid_ingest_state_e)ch->state;
+}
+
+/**
+ * @brief run pid_ingest_apply for count handlers, channel i drives pid[i]
+ * 
+ * @param in 
+ * @param pid           array of count handlers, eg: bank->pid
+ * @param count         <= number of channels
+ * @param now_us        tick time
+ * @return size_t       number of channels which were not fresh
+ */
+size_t pid_ingest_apply_bank(pid_ingest_t *in, pid_handle_t *pid, size_t count, uint32_t now_us)
+{
+    size_t stale = 0;
+
+    if (!in || !pid || (count > in->count))
+        return 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pid_ingest_apply(in, i, &pid[i], now_us) != PID_INGEST_FRESH)
+            stale++;
+    }
+    return stale;
+}
+
+/**
+ * @brief clear a PID_INGEST_MANUAL latch and restore the previous operation mode
+ * 
+ * @param in 
+ * @param channel 
+ * @param pid 
+ * @return pid_result_t PID_ERROR if the channel is not latched
+ */
+pid_result_t pid_ingest_reset(pid_ingest_t *in, size_t channel, pid_handle_t *pid)
+{
+    PID_RETURN_IF_NULL(in);
+    PID_RETURN_IF_NULL(pid);
+    if ((channel >= in->count) || (in->channel[channel].state != PID_INGEST_LATCHED))
+        return PID_ERROR;
+
+    pid_set_operation_mode(pid, in->channel[channel].mode);
+    // back to stale: the next new sample makes the channel fresh
+    in->channel[channel].state = PID_INGEST_STALE;
+    return PID_OK;
+}
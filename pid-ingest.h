@@ -0,0 +1,187 @@
+/**
+ * @file pid-ingest.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief lock free latest value pv registers
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * Every channel has one 64 bit register holding the latest pv and its
+ * timestamp (uint32 microseconds << 32 | float bits). Any number of
+ * acquisition threads write it with pid_ingest_write() (compare and swap,
+ * an older sample never replaces a newer one); the control tick reads it
+ * with one atomic load in pid_ingest_apply().
+ *
+ * A sample older than max_age_us is stale, the channel policy is applied
+ * instead of the pid calculation:
+ *  - PID_INGEST_HOLD:     the output is held
+ *  - PID_INGEST_FAILSAFE: the output is set to the failsafe value
+ *  - PID_INGEST_MANUAL:   the output is held and the handler is switched to
+ *                         PID_MANUAL_MODE, latched until pid_ingest_reset()
+ * The history of the handler is kept flat as in the event driven mode, the
+ * first computed sample after a stale period starts from the held output
+ * without a bump.
+ *
+ * The timestamps wrap every 71 minutes; a channel whose register is not
+ * updated stays stale whatever its age.
+ */
+#ifndef __PID_INGEST_H__
+#define __PID_INGEST_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pid.h"
+
+#define PID_INGEST_CACHE_LINE (64U)
+
+    typedef enum _pid_ingest_policy_e
+    {
+        PID_INGEST_HOLD = 0,
+        PID_INGEST_FAILSAFE,
+        PID_INGEST_MANUAL,
+        PID_INGEST_POLICY_MAX,
+    } pid_ingest_policy_e;
+
+    typedef enum _pid_ingest_state_e
+    {
+        PID_INGEST_EMPTY = 0, // never written
+        PID_INGEST_FRESH,
+        PID_INGEST_STALE,
+        PID_INGEST_LATCHED, // stale with PID_INGEST_MANUAL, until pid_ingest_reset
+    } pid_ingest_state_e;
+
+    /**
+     * @brief register written by the producers, one cache line per channel
+     * so that producers of different channels do not share a line
+     */
+    typedef struct _pid_ingest_register_t
+    {
+        uint64_t latest;   // time_us << 32 | float bits, 0 if never written
+        uint64_t rejected; // writes older than the register
+        uint8_t reserved[PID_INGEST_CACHE_LINE - 2 * sizeof(uint64_t)];
+    } pid_ingest_register_t;
+
+    /**
+     * @brief configuration and state of a channel, control thread only
+     */
+    typedef struct _pid_ingest_channel_t
+    {
+        uint32_t max_age_us;
+        pid_ingest_policy_e policy;
+        float failsafe;          // output of PID_INGEST_FAILSAFE, same unit as cv.buff
+        pid_ingest_state_e state;
+        pid_operation_mode_e mode; // mode before the PID_INGEST_MANUAL latch
+        uint32_t last_time;      // timestamp of the last used sample
+        uint64_t stale_ticks;    // ticks with a stale sample
+        uint64_t stale_events;   // fresh to stale transitions
+    } pid_ingest_channel_t;
+
+    typedef struct _pid_ingest_t
+    {
+        pid_ingest_register_t *reg;
+        pid_ingest_channel_t *channel;
+        size_t count;
+    } pid_ingest_t;
+
+    /**
+     * @brief allocate count channels, policy PID_INGEST_HOLD
+     * 
+     * @param in 
+     * @param count         number of channels
+     * @param max_age_us    default age above which a sample is stale
+     * @return pid_result_t 
+     */
+    pid_result_t pid_ingest_create(pid_ingest_t *in, size_t count, uint32_t max_age_us);
+
+    /**
+     * @brief release the channels
+     * 
+     * @param in 
+     */
+    void pid_ingest_destroy(pid_ingest_t *in);
+
+    /**
+     * @brief configure the stale handling of a channel (control thread)
+     * 
+     * @param in 
+     * @param channel 
+     * @param max_age_us    age above which a sample is stale
+     * @param policy 
+     * @param failsafe      output of PID_INGEST_FAILSAFE
+     * @return pid_result_t 
+     */
+    pid_result_t pid_ingest_set_policy(pid_ingest_t *in, size_t channel, uint32_t max_age_us,
+                                       pid_ingest_policy_e policy, float failsafe);
+
+    /**
+     * @brief monotonic time in microseconds, truncated to 32 bits
+     * 
+     * @return uint32_t 
+     */
+    uint32_t pid_ingest_now_us(void);
+
+    /**
+     * @brief store a sample, lock free, any thread
+     * 
+     * @param in 
+     * @param channel 
+     * @param pv 
+     * @param time_us       acquisition time, pid_ingest_now_us() clock
+     * @return pid_result_t PID_ERROR if the register holds a newer sample
+     */
+    pid_result_t pid_ingest_write(pid_ingest_t *in, size_t channel, float pv, uint32_t time_us);
+
+    /**
+     * @brief read the latest sample of a channel
+     * 
+     * @param in 
+     * @param channel 
+     * @param pv 
+     * @param time_us       timestamp of the sample, can be NULL
+     * @return pid_result_t PID_ERROR if the channel was never written
+     */
+    pid_result_t pid_ingest_read(const pid_ingest_t *in, size_t channel, float *pv, uint32_t *time_us);
+
+    /**
+     * @brief run one tick of pid with the latest sample of a channel, or apply
+     * the stale policy (control thread)
+     * 
+     * @param in 
+     * @param channel 
+     * @param pid 
+     * @param now_us        tick time, pid_ingest_now_us() clock
+     * @return pid_ingest_state_e
+     */
+    pid_ingest_state_e pid_ingest_apply(pid_ingest_t *in, size_t channel, pid_handle_t *pid, uint32_t now_us);
+
+    /**
+     * @brief run pid_ingest_apply for count handlers, channel i drives pid[i]
+     * 
+     * @param in 
+     * @param pid           array of count handlers, eg: bank->pid
+     * @param count         <= number of channels
+     * @param now_us        tick time
+     * @return size_t       number of channels which were not fresh
+     */
+    size_t pid_ingest_apply_bank(pid_ingest_t *in, pid_handle_t *pid, size_t count, uint32_t now_us);
+
+    /**
+     * @brief clear a PID_INGEST_MANUAL latch and restore the previous operation mode
+     * 
+     * @param in 
+     * @param channel 
+     * @param pid 
+     * @return pid_result_t PID_ERROR if the channel is not latched
+     */
+    pid_result_t pid_ingest_reset(pid_ingest_t *in, size_t channel, pid_handle_t *pid);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __PID_INGEST_H__
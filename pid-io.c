@@ -70,6 +70,7 @@ pid_result_t io_set_pv_input(pid_handle_t *pid, io_type_e input_type, int adc_re
     pid->control.pv.io.type = input_type;
     pid->control.pv.adc.resolution = adc_resolution;
     io_set_io_type(&pid->control.pv);
+    pid->flag |= PID_INIT_PV_IO;
     return PID_OK;
 }
 
@@ -87,6 +88,7 @@ pid_result_t io_set_cv_output(pid_handle_t *pid, io_type_e output_type, int adc_
     pid->control.cv_output.io.type = output_type;
     pid->control.cv_output.adc.resolution = adc_resolution;
     io_set_io_type(&pid->control.cv_output);
+    pid->flag |= PID_INIT_CV_IO;
     return PID_OK;
 }
 
@@ -106,27 +108,170 @@ pid_result_t io_get_pv_value(pid_handle_t *pid, int adc_value)
 
     // get the pv in voltage or current
     // eg: [0 - 5V] <=> [0 - 32767] => 2V <=> 13,107 (ADC 16bit value)
-    pid->control.pv.value = io_sub * (adc_value / pid->control.pv.adc.resolution) + pid->control.pv.io.offset;
+    pid->control.pv.value = io_sub * ((float)adc_value / (float)pid->control.pv.adc.resolution) + pid->control.pv.io.offset;
 
     // get the final pv value
     // eg: [0 - 5V] <=> [0 - 1000] rpm => 2V <=> 400 rpm
-    pid->control.pv.value = (pid->control.pv.max - pid->control.pv.min) * pid->control.pv.value / io_sub + pid->control.pv.min;
+    pid->control.pv.value = (pid->control.pv.max - pid->control.pv.min) * (pid->control.pv.value - pid->control.pv.io.offset) / io_sub + pid->control.pv.min;
 
     pid->err = PID_OK;
     return PID_OK;
 }
 
 /**
- * @brief convert control value of pid controller to output value
- * the output value will be store in pid->output.adc.value
+ * @brief output stage of one pid handler
  * 
  * @param pid               pid handler
  * @return pid_result_t     error code
  */
+static inline pid_result_t io_output_stage(pid_handle_t *pid)
+{
+    pid_control_t *ctrl = &pid->control;
+    cv_output_t *out = &ctrl->cv_output;
+    float cv = ctrl->cv.buff[0];
+    float cv_sub = ctrl->cv.max - ctrl->cv.min;
+    float io_sub = out->io.range - out->io.offset;
+    float fraction, step, full_scale;
+    int64_t code, delta;
+
+    if (!(cv_sub > 0) || (out->adc.resolution < 2))
+        return PID_ERR_LIMIT;
+    // a rate step of 0 would freeze the output at its first value
+    if (ctrl->output.rate.enable && !(ctrl->sample_time > 0))
+        return PID_ERR_S;
+
+    full_scale = (float)(out->adc.resolution - 1);
+
+    // 1. gain and [cv.min; cv.max] => [0; 1]
+    if (ctrl->cv.gain.enable)
+        cv *= ctrl->cv.gain.value;
+    fraction = (cv - ctrl->cv.min) / cv_sub;
+    if (fraction < 0)
+        fraction = 0;
+    if (fraction > 1)
+        fraction = 1;
+
+    // 2. rate limitation, in percent per second
+    if (ctrl->output.valid && ctrl->output.rate.enable)
+    {
+        step = ctrl->output.rate.value * ctrl->sample_time / 100.0f;
+        if (fraction > ctrl->output.fraction + step)
+            fraction = ctrl->output.fraction + step;
+        if (fraction < ctrl->output.fraction - step)
+            fraction = ctrl->output.fraction - step;
+    }
+
+    // 3. dac code and slew limitation, in code per update
+    code = (int64_t)(fraction * full_scale + 0.5f);
+    if (ctrl->output.valid && ctrl->output.slew.enable)
+    {
+        delta = (int64_t)ctrl->output.slew.value;
+        if (code > (int64_t)ctrl->output.code + delta)
+            code = (int64_t)ctrl->output.code + delta;
+        else if (code < (int64_t)ctrl->output.code - delta)
+            code = (int64_t)ctrl->output.code - delta;
+        else
+            delta = -1;
+
+        // clamped: the next rate limitation starts from the written code
+        if (delta >= 0)
+            fraction = (float)code / full_scale;
+    }
+    ctrl->output.fraction = fraction;
+    ctrl->output.code = (uint32_t)code;
+    ctrl->output.valid = true;
+
+    // 4. output value of the written code, eg: [0 - 32767] => [4 - 20] mA
+    out->adc.value = (float)code;
+    out->percent = 100.0f * (float)code / full_scale;
+    out->value = out->io.offset + io_sub * (float)code / full_scale;
+    return PID_OK;
+}
+
+/**
+ * @brief convert control value of pid controller to output value
+ * cv.buff[0] is scaled by the gain, mapped from [cv.min; cv.max] to the
+ * output io range, rate and slew limited, and the dac code is stored in
+ * pid->control.output.code (and pid->control.cv_output.adc.value)
+ * 
+ * @param pid               pid handler
+ * @return pid_result_t     error code, PID_ERR_S if the rate limitation is enabled
+ * without a sample time
+ */
 pid_result_t io_get_output_value(pid_handle_t *pid)
 {
     PID_RETURN_IF_NULL(pid);
-    float io_sub = pid->control.cv_output.io.range - pid->control.cv_output.io.offset;
+    pid->err = io_output_stage(pid);
+    return pid->err;
+}
+
+/**
+ * @brief set the output rate limitation
+ * 
+ * @param pid               pid handler
+ * @param rate              maximum output change in percent per second, > 0 when enabled
+ * @return pid_result_t     error code, PID_ERR_S if the sample time is not set yet
+ */
+pid_result_t io_set_output_rate_limit(pid_handle_t *pid, pid_rate_limit_t *rate)
+{
+    PID_RETURN_IF_NULL(pid);
+    PID_RETURN_IF_NULL(rate);
+    if ((rate->value < 0) || (rate->enable && !(rate->value > 0)))
+        return PID_ERR_LIMIT;
+    // the step per update is value * sample_time
+    if (rate->enable && !(pid->control.sample_time > 0))
+        return PID_ERR_S;
+    memcpy(&pid->control.output.rate, rate, sizeof(pid_rate_limit_t));
+    pid->err = PID_OK;
+    return PID_OK;
+}
+
+/**
+ * @brief set the output slew limitation
+ * 
+ * @param pid               pid handler
+ * @param slew              maximum dac code change per update, 0 or >= 1
+ * @return pid_result_t     error code
+ */
+pid_result_t io_set_output_slew_limit(pid_handle_t *pid, pid_rate_limit_t *slew)
+{
+    PID_RETURN_IF_NULL(pid);
+    PID_RETURN_IF_NULL(slew);
+    // whole codes only, a step below one code would freeze the output
+    if (slew->value < 0 || (slew->value > 0 && slew->value < 1))
+        return PID_ERR_LIMIT;
+    memcpy(&pid->control.output.slew, slew, sizeof(pid_rate_limit_t));
     pid->err = PID_OK;
     return PID_OK;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief convert the outputs of count contiguous pid handlers to dac codes
+ * in one pass, eg: a dma buffer for a multi channel dac
+ * 
+ * @param pid               array of count pid handlers
+ * @param count             number of handlers
+ * @param dac               array of count dac codes
+ * @return pid_result_t     error code, the code of a failed channel is held,
+ * PID_ERR_LIMIT for a channel wider than PID_IO_DAC_RESOLUTION_MAX codes
+ */
+pid_result_t io_convert_outputs(pid_handle_t *pid, size_t count, uint16_t *dac)
+{
+    pid_result_t err = PID_OK, ret;
+
+    PID_RETURN_IF_NULL(pid);
+    PID_RETURN_IF_NULL(dac);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pid[i].control.cv_output.adc.resolution > PID_IO_DAC_RESOLUTION_MAX)
+            ret = PID_ERR_LIMIT;
+        else
+            ret = io_output_stage(&pid[i]);
+        pid[i].err = ret;
+        if (ret != PID_OK)
+            err = ret;
+        dac[i] = (uint16_t)pid[i].control.output.code;
+    }
+    return err;
+}
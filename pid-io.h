@@ -18,8 +18,11 @@ extern "C"
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "pid-typedef.h"
 
+#define PID_IO_DAC_RESOLUTION_MAX (65536) // codes of a uint16_t dac word
+
     /**
      * @brief set pv input io type and adc resolution
      * 
@@ -53,13 +56,46 @@ extern "C"
 
     /**
      * @brief convert control value of pid controller to output value
-     * the output value will be store in pid->output.adc.value
+     * cv.buff[0] is scaled by the gain, mapped from [cv.min; cv.max] to the
+     * output io range, rate and slew limited, and the dac code is stored in
+     * pid->control.output.code (and pid->control.cv_output.adc.value)
      * 
      * @param pid               pid handler
-     * @return pid_result_t     error code
+     * @return pid_result_t     error code, PID_ERR_S if the rate limitation is enabled
+     * without a sample time
      */
     pid_result_t io_get_output_value(pid_handle_t *pid);
 
+    /**
+     * @brief set the output rate limitation
+     * 
+     * @param pid               pid handler
+     * @param rate              maximum output change in percent per second, > 0 when enabled
+     * @return pid_result_t     error code, PID_ERR_S if the sample time is not set yet
+     */
+    pid_result_t io_set_output_rate_limit(pid_handle_t *pid, pid_rate_limit_t *rate);
+
+    /**
+     * @brief set the output slew limitation
+     * 
+     * @param pid               pid handler
+     * @param slew              maximum dac code change per update, 0 or >= 1
+     * @return pid_result_t     error code
+     */
+    pid_result_t io_set_output_slew_limit(pid_handle_t *pid, pid_rate_limit_t *slew);
+
+    /**
+     * @brief convert the outputs of count contiguous pid handlers to dac codes
+     * in one pass, eg: a dma buffer for a multi channel dac
+     * 
+     * @param pid               array of count pid handlers
+     * @param count             number of handlers
+     * @param dac               array of count dac codes
+     * @return pid_result_t     error code, the code of a failed channel is held,
+     * PID_ERR_LIMIT for a channel wider than PID_IO_DAC_RESOLUTION_MAX codes
+     */
+    pid_result_t io_convert_outputs(pid_handle_t *pid, size_t count, uint16_t *dac);
+
 #ifdef __cplusplus
 }
 #endif
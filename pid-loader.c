@@ -0,0 +1,392 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "pid-loader.h"
+#include <stdlib.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef struct _pid_loader_job_t
+{
+    pid_bank_t *bank;
+    const char *data;
+    const uint64_t *start; // offset of each configuration line
+    const uint64_t *number; // file line number of each configuration line
+    uint64_t size;
+    size_t begin;
+    size_t end;
+    uint64_t loaded;
+    uint64_t failed;
+    uint64_t first_line;
+} pid_loader_job_t;
+
+static uint64_t loader_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief split a line into fields, the fields are copied and trimmed
+ * 
+ * @param line 
+ * @param end 
+ * @param field         array of PID_LOADER_MAX_FIELDS fields
+ * @return int          number of fields, -1 if a field is too long or there are too many fields
+ */
+static int pid_loader_split(const char *line, const char *end, char field[][PID_LOADER_FIELD_SIZE])
+{
+    int n = 0;
+
+    while (line <= end)
+    {
+        const char *p = line, *q;
+        size_t len;
+
+        while ((p < end) && (*p != ','))
+            p++;
+        q = p;
+        while ((line < q) && isspace((unsigned char)*line))
+            line++;
+        while ((q > line) && isspace((unsigned char)q[-1]))
+            q--;
+
+        len = (size_t)(q - line);
+        if ((n >= (int)PID_LOADER_MAX_FIELDS) || (len >= PID_LOADER_FIELD_SIZE))
+            return -1;
+        memcpy(field[n], line, len);
+        field[n][len] = '\0';
+        n++;
+        line = p + 1;
+    }
+    return n;
+}
+
+static bool pid_loader_float(const char *field, float *value)
+{
+    char *end;
+
+    errno = 0;
+    *value = strtof(field, &end);
+    return (end != field) && (*end == '\0') && (errno == 0);
+}
+
+static bool pid_loader_int(const char *field, int *value)
+{
+    char *end;
+    long v;
+
+    errno = 0;
+    v = strtol(field, &end, 0);
+    if ((end == field) || (*end != '\0') || (errno != 0) || (v < INT_MIN) || (v > INT_MAX))
+        return false;
+    *value = (int)v;
+    return true;
+}
+
+/**
+ * @brief an empty field is a disabled property
+ */
+static bool pid_loader_property(const char *field, pid_control_property_t *prop)
+{
+    prop->value = 0;
+    prop->enable = (field[0] != '\0');
+    return !prop->enable || pid_loader_float(field, &prop->value);
+}
+
+/**
+ * @brief configure one pid handler from one csv line
+ * 
+ * @param pid 
+ * @param line          start of the line
+ * @param end           end of the line (excluded)
+ * @return pid_result_t 
+ */
+pid_result_t pid_loader_parse_line(pid_handle_t *pid, const char *line, const char *end)
+{
+    char field[PID_LOADER_MAX_FIELDS][PID_LOADER_FIELD_SIZE];
+    float f[9], tf = 0;
+    int type, ctrl, mode, pv_io, pv_res, cv_io, cv_res, method = PID_DISCRETE_TUSTIN;
+    pid_control_property_t limit_h, limit_l, gain;
+    pid_para_t para;
+    pid_result_t err;
+    int n;
+
+    PID_RETURN_IF_NULL(pid);
+    PID_RETURN_IF_NULL(line);
+
+    memset(pid, 0, sizeof(pid_handle_t));
+    pid->err = PID_ERROR;
+
+    n = pid_loader_split(line, end, field);
+    if (n < (int)PID_LOADER_MIN_FIELDS)
+        return PID_ERROR;
+
+    for (int i = 0; i < 9; i++)
+    {
+        if (!pid_loader_float(field[i], &f[i]))
+            return PID_ERROR;
+    }
+    if (!pid_loader_int(field[9], &type) || !pid_loader_int(field[10], &ctrl) ||
+        !pid_loader_int(field[11], &mode) || !pid_loader_int(field[12], &pv_io) ||
+        !pid_loader_int(field[13], &pv_res) || !pid_loader_int(field[14], &cv_io) ||
+        !pid_loader_int(field[15], &cv_res) || !pid_loader_property(field[16], &limit_h) ||
+        !pid_loader_property(field[17], &limit_l) || !pid_loader_property(field[18], &gain))
+        return PID_ERROR;
+    if ((n > 19) && (field[19][0] != '\0') && !pid_loader_int(field[19], &method))
+        return PID_ERROR;
+    if ((n > 20) && (field[20][0] != '\0') && !pid_loader_float(field[20], &tf))
+        return PID_ERROR;
+
+    if ((type & ~(int)(PID_ENABLE_P | PID_ENABLE_I | PID_ENABLE_D)) ||
+        (ctrl < PID_METHOD_POSITIVE) || (ctrl > PID_METHOD_BIO) ||
+        (mode < PID_MANUAL_MODE) || (mode > PID_AUTO_MODE) ||
+        (pv_io < IO_0_5VDC) || (pv_io > IO_1_24VDC) || (cv_io < IO_0_5VDC) || (cv_io > IO_1_24VDC) ||
+        (pv_res < 2) || (cv_res < 2))
+        return PID_ERROR;
+
+    // same setters as the single handler path, without the eeprom writes
+    memset(&para, 0, sizeof(para));
+    para.kp = f[0];
+    para.ki = f[1];
+    para.kd = f[2];
+    // pid_set_parameter() copies the whole parameter, the type goes after it
+    pid_set_parameter(pid, &para);
+    pid_set_pid_type(pid, type);
+    pid_set_output_ctrl_method(pid, (pid_output_ctrl_method_e)ctrl);
+    pid_set_operation_mode(pid, (pid_operation_mode_e)mode);
+    pid_set_pv_range(pid, f[6], f[5]);
+    pid_set_cv_max_min(pid, f[8], f[7]);
+    io_set_pv_input(pid, (io_type_e)pv_io, pv_res);
+    io_set_cv_output(pid, (io_type_e)cv_io, cv_res);
+    pid_set_cv_limit_h(pid, &limit_h);
+    pid_set_cv_limit_l(pid, &limit_l);
+    pid_set_gain(pid, &gain);
+    pid_set_sv_value(pid, f[4]);
+
+    if ((err = pid_set_sample_time(pid, f[3])) != PID_OK)
+        return err;
+    if ((err = pid_set_discrete_method(pid, (pid_discrete_method_e)method, tf)) != PID_OK)
+        return err;
+    if ((err = pid_extend_param_cal(pid)) != PID_OK)
+        return err;
+    return pid_arm(pid);
+}
+
+static void *pid_loader_thread(void *arg)
+{
+    pid_loader_job_t *job = (pid_loader_job_t *)arg;
+
+    for (size_t i = job->begin; i < job->end; i++)
+    {
+        const char *line = job->data + job->start[i];
+        const char *end = memchr(line, '\n', (size_t)(job->size - job->start[i]));
+
+        if (!end)
+            end = job->data + job->size;
+        if ((end > line) && (end[-1] == '\r'))
+            end--;
+
+        if (pid_loader_parse_line(&job->bank->pid[i], line, end) == PID_OK)
+        {
+            job->loaded++;
+        }
+        else
+        {
+            if (job->failed++ == 0)
+                job->first_line = job->number[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief index the configuration lines, skipping comments, blank lines and the header
+ * 
+ * @param data 
+ * @param size 
+ * @param start         offsets, NULL to count only
+ * @param number        file line numbers, NULL to count only
+ * @return size_t       number of configuration lines
+ */
+static size_t pid_loader_index(const char *data, uint64_t size, uint64_t *start, uint64_t *number)
+{
+    size_t count = 0;
+    uint64_t pos = 0, line = 0;
+    bool first = true;
+
+    while (pos < size)
+    {
+        const char *nl = memchr(data + pos, '\n', (size_t)(size - pos));
+        uint64_t next = nl ? (uint64_t)(nl - data) + 1 : size;
+        uint64_t p = pos;
+
+        line++;
+        while ((p < next) && (data[p] == ' ' || data[p] == '\t' || data[p] == '\r'))
+            p++;
+
+        if ((p < next) && (data[p] != '\n') && (data[p] != '#'))
+        {
+            if (!(first && isalpha((unsigned char)data[p])))
+            {
+                if (start)
+                {
+                    start[count] = pos;
+                    number[count] = line;
+                }
+                count++;
+            }
+            first = false;
+        }
+        pos = next;
+    }
+    return count;
+}
+
+/**
+ * @brief load a csv configuration file into a new bank
+ * The handler of a failed line is left unarmed with pid->err set
+ * 
+ * @param bank          bank to be created, release it with pid_bank_destroy
+ * @param path          csv file
+ * @param threads       number of threads, 0 for one per online cpu
+ * @param stats         can be NULL
+ * @return pid_result_t PID_OK if every line is loaded
+ */
+pid_result_t pid_loader_load(pid_bank_t *bank, const char *path, uint32_t threads, pid_loader_stats_t *stats)
+{
+    pid_loader_job_t job[PID_LOADER_MAX_THREADS];
+    pthread_t thread[PID_LOADER_MAX_THREADS];
+    bool spawned[PID_LOADER_MAX_THREADS];
+    pid_loader_stats_t st;
+    uint64_t *start = NULL, *number = NULL;
+    uint64_t t0, t1;
+    const char *data = NULL;
+    struct stat sb;
+    size_t count;
+    int fd;
+
+    PID_RETURN_IF_NULL(bank);
+    PID_RETURN_IF_NULL(path);
+
+    memset(&st, 0, sizeof(st));
+    memset(bank, 0, sizeof(pid_bank_t));
+    t0 = loader_now_ns();
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if ((fd < 0) || (fstat(fd, &sb) != 0))
+    {
+        PID_LOG("can not open the configuration file, errno %d\n", errno);
+        if (fd >= 0)
+            close(fd);
+        return PID_ERROR;
+    }
+    if (sb.st_size > 0)
+    {
+        data = (const char *)mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            PID_LOG("can not map the configuration file, errno %d\n", errno);
+            close(fd);
+            return PID_ERROR;
+        }
+        madvise((void *)data, (size_t)sb.st_size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+    t1 = loader_now_ns();
+    st.map_ns = t1 - t0;
+
+    // two passes over the mapping: count, then index into exact size arrays
+    count = data ? pid_loader_index(data, (uint64_t)sb.st_size, NULL, NULL) : 0;
+    if (count)
+    {
+        start = (uint64_t *)malloc(count * sizeof(uint64_t));
+        number = (uint64_t *)malloc(count * sizeof(uint64_t));
+        // every handler is fully configured by its line, no pid_set_default
+        bank->pid = (pid_handle_t *)calloc(count, sizeof(pid_handle_t));
+        if (!start || !number || !bank->pid)
+        {
+            PID_LOG("can not allocate %u pid handlers\n", (unsigned)count);
+            free(start);
+            free(number);
+            free(bank->pid);
+            bank->pid = NULL;
+            munmap((void *)data, (size_t)sb.st_size);
+            return PID_ERR_MEM;
+        }
+        pid_loader_index(data, (uint64_t)sb.st_size, start, number);
+        bank->count = count;
+    }
+    st.lines = count;
+    st.index_ns = loader_now_ns() - t1;
+    t1 = loader_now_ns();
+
+    if (!threads)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (uint32_t)cpus : 1U;
+    }
+    if (threads > PID_LOADER_MAX_THREADS)
+        threads = PID_LOADER_MAX_THREADS;
+    if (threads > count)
+        threads = count ? (uint32_t)count : 1U;
+    st.threads = threads;
+
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        memset(&job[t], 0, sizeof(pid_loader_job_t));
+        job[t].bank = bank;
+        job[t].data = data;
+        job[t].start = start;
+        job[t].number = number;
+        job[t].size = (uint64_t)sb.st_size;
+        job[t].begin = count * t / threads;
+        job[t].end = count * (t + 1) / threads;
+    }
+
+    // the calling thread takes the first job
+    for (uint32_t t = 1; t < threads; t++)
+    {
+        spawned[t] = (pthread_create(&thread[t], NULL, pid_loader_thread, &job[t]) == 0);
+        if (!spawned[t])
+            pid_loader_thread(&job[t]);
+    }
+    pid_loader_thread(&job[0]);
+    for (uint32_t t = 1; t < threads; t++)
+    {
+        if (spawned[t])
+            pthread_join(thread[t], NULL);
+    }
+
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        st.loaded += job[t].loaded;
+        if (job[t].failed && !st.failed)
+            st.first_line = job[t].first_line;
+        st.failed += job[t].failed;
+    }
+    st.parse_ns = loader_now_ns() - t1;
+
+    free(start);
+    free(number);
+    if (data)
+        munmap((void *)data, (size_t)sb.st_size);
+    st.total_ns = loader_now_ns() - t0;
+
+    if (stats)
+        memcpy(stats, &st, sizeof(st));
+    if (st.failed)
+    {
+        PID_LOGW("%u configuration lines failed, first at line %u\n", (unsigned)st.failed, (unsigned)st.first_line);
+        return PID_ERROR;
+    }
+    return PID_OK;
+}
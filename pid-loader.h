@@ -0,0 +1,79 @@
+/**
+ * @file pid-loader.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief bulk configuration loader
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * One pid handler per line of a csv file, '#' starts a comment line, a first
+ * line starting with a letter is a header and is skipped. Columns:
+ *
+ *   kp, ki, kd, sample_time, sv, pv_min, pv_max, cv_min, cv_max,
+ *   type (PID_ENABLE_x mask), ctrl_method (pid_output_ctrl_method_e),
+ *   mode (pid_operation_mode_e), pv_io (io_type_e), pv_resolution,
+ *   cv_io (io_type_e), cv_resolution, limit_h, limit_l, gain,
+ *   [method (pid_discrete_method_e), tf]
+ *
+ * An empty limit_h / limit_l / gain field disables it. A type with bits
+ * outside the PID_ENABLE_x mask, or an integer field out of the int range,
+ * fails the line. The file is mapped, the lines are indexed, then the lines
+ * are parsed, validated and armed by several threads. No eeprom write is
+ * done: call pid_save_data() for the handlers which have to be persisted.
+ */
+#ifndef __PID_LOADER_H__
+#define __PID_LOADER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include "pid-bank.h"
+
+#define PID_LOADER_MIN_FIELDS (19U)
+#define PID_LOADER_MAX_FIELDS (21U)
+#define PID_LOADER_FIELD_SIZE (64U)
+#define PID_LOADER_MAX_THREADS (64U)
+
+    typedef struct _pid_loader_stats_t
+    {
+        uint64_t lines;      // configuration lines
+        uint64_t loaded;     // handlers parsed, validated and armed
+        uint64_t failed;     // lines which could not be loaded
+        uint64_t first_line; // file line number (from 1) of the first failed line
+        uint32_t threads;    // number of threads used
+        uint64_t map_ns;     // open + mmap
+        uint64_t index_ns;   // line indexing + allocation
+        uint64_t parse_ns;   // parallel parsing, validation and arming
+        uint64_t total_ns;
+    } pid_loader_stats_t;
+
+    /**
+     * @brief load a csv configuration file into a new bank
+     * The handler of a failed line is left unarmed with pid->err set
+     * 
+     * @param bank          bank to be created, release it with pid_bank_destroy
+     * @param path          csv file
+     * @param threads       number of threads, 0 for one per online cpu
+     * @param stats         can be NULL
+     * @return pid_result_t PID_OK if every line is loaded
+     */
+    pid_result_t pid_loader_load(pid_bank_t *bank, const char *path, uint32_t threads, pid_loader_stats_t *stats);
+
+    /**
+     * @brief configure one pid handler from one csv line
+     * 
+     * @param pid 
+     * @param line          start of the line
+     * @param end           end of the line (excluded)
+     * @return pid_result_t 
+     */
+    pid_result_t pid_loader_parse_line(pid_handle_t *pid, const char *line, const char *end);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __PID_LOADER_H__
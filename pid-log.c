@@ -0,0 +1,311 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "pid-log.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
+
+#define PID_LOG_RING_MASK (PID_LOG_RING_SIZE - 1U)
+#define PID_LOG_SPEC_SIZE (32U)
+
+typedef struct _pid_log_record_t
+{
+    uint32_t turn; // sequence of the cell, relative to the cell index
+    uint32_t nargs;
+    const pid_log_site_t *site;
+    pid_log_arg_t args[PID_LOG_MAX_ARGS];
+} pid_log_record_t;
+
+/**
+ * @brief bounded multi producer ring (Vyukov), one consumer
+ * The turn of a cell is stored relative to its index, so that the zero
+ * initialized ring is valid without any init call
+ */
+static struct pid_log_ring_t
+{
+    uint64_t head; // next position to be written by the producers
+    uint64_t tail; // next position to be read by the consumer
+    uint64_t dropped;
+    pid_log_record_t cell[PID_LOG_RING_SIZE];
+} ring;
+
+static struct pid_log_thread_t
+{
+    pthread_t thread;
+    FILE *out;
+    uint32_t period_ms;
+    int running;
+} worker;
+
+static const char *const level_name[] = {"E", "W", "I", "D"};
+
+/**
+ * @brief store a message into the ring, never blocks
+ * the message is dropped if the ring is full
+ *
+ * @param site      message site
+ * @param nargs     number of valid arguments
+ */
+void pid_log_write(const pid_log_site_t *site, uint32_t nargs,
+                   pid_log_arg_t a0, pid_log_arg_t a1, pid_log_arg_t a2, pid_log_arg_t a3)
+{
+    uint64_t pos = __atomic_load_n(&ring.head, __ATOMIC_RELAXED);
+    pid_log_record_t *cell;
+
+    for (;;)
+    {
+        cell = &ring.cell[pos & PID_LOG_RING_MASK];
+        uint32_t seq = __atomic_load_n(&cell->turn, __ATOMIC_ACQUIRE) + (uint32_t)(pos & PID_LOG_RING_MASK);
+        int32_t diff = (int32_t)(seq - (uint32_t)pos);
+
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&ring.head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // full, the consumer has not freed this cell yet
+            __atomic_fetch_add(&ring.dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        else
+        {
+            pos = __atomic_load_n(&ring.head, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->site = site;
+    cell->nargs = nargs;
+    cell->args[0] = a0;
+    cell->args[1] = a1;
+    cell->args[2] = a2;
+    cell->args[3] = a3;
+    __atomic_store_n(&cell->turn, (uint32_t)(pos + 1) - (uint32_t)(pos & PID_LOG_RING_MASK), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief print one conversion of the format with a raw argument
+ *
+ * @param out
+ * @param spec      conversion specification, eg: "%-8.3lf"
+ * @param len       length of spec
+ * @param arg
+ */
+static void pid_log_print_arg(FILE *out, const char *spec, size_t len, pid_log_arg_t arg)
+{
+    char fmt[PID_LOG_SPEC_SIZE];
+    char conv = spec[len - 1];
+    size_t n = 0;
+    double d;
+
+    // keep flags, width and precision, drop the length modifiers
+    for (size_t i = 0; i < len - 1 && n < sizeof(fmt) - 4; i++)
+    {
+        if (!strchr("hljztL", spec[i]))
+            fmt[n++] = spec[i];
+    }
+
+    switch (conv)
+    {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o':
+        fmt[n++] = 'l';
+        fmt[n++] = 'l';
+        fmt[n++] = conv;
+        fmt[n] = '\0';
+        if (conv == 'd' || conv == 'i')
+            fprintf(out, fmt, (long long)arg);
+        else
+            fprintf(out, fmt, (unsigned long long)arg);
+        break;
+
+    case 'c':
+        fmt[n++] = conv;
+        fmt[n] = '\0';
+        fprintf(out, fmt, (int)arg);
+        break;
+
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        fmt[n++] = conv;
+        fmt[n] = '\0';
+        memcpy(&d, &arg, sizeof(d));
+        fprintf(out, fmt, d);
+        break;
+
+    case 's':
+        fmt[n++] = conv;
+        fmt[n] = '\0';
+        fprintf(out, fmt, arg ? (const char *)(uintptr_t)arg : "(null)");
+        break;
+
+    case 'p':
+        fprintf(out, "%p", (void *)(uintptr_t)arg);
+        break;
+
+    default:
+        fwrite(spec, 1, len, out);
+        break;
+    }
+}
+
+/**
+ * @brief print a record, the format is parsed here instead of in the hot path
+ *
+ * @param out
+ * @param rec
+ */
+static void pid_log_print(FILE *out, const pid_log_record_t *rec)
+{
+    const pid_log_site_t *site = rec->site;
+    const char *file = strrchr(site->file, '/');
+    const char *p = site->fmt, *start;
+    uint32_t arg = 0;
+
+    if (!file)
+        file = strrchr(site->file, '\\');
+    file = file ? file + 1 : site->file;
+
+    fprintf(out, "[PID_LOG] --> %s file %s, line %d: ",
+            (site->level >= 0 && site->level <= PID_LOG_LEVEL_DEBUG) ? level_name[site->level] : "?",
+            file, site->line);
+
+    while (*p)
+    {
+        if (*p != '%')
+        {
+            start = p;
+            while (*p && *p != '%')
+                p++;
+            fwrite(start, 1, (size_t)(p - start), out);
+            continue;
+        }
+        if (p[1] == '%')
+        {
+            fputc('%', out);
+            p += 2;
+            continue;
+        }
+
+        start = p++;
+        while (*p && !strchr("diuxXocfFeEgGaAsp", *p))
+            p++;
+        if (!*p)
+        {
+            fputs(start, out);
+            break;
+        }
+        p++;
+
+        if (arg < rec->nargs)
+            pid_log_print_arg(out, start, (size_t)(p - start), rec->args[arg++]);
+        else
+            fwrite(start, 1, (size_t)(p - start), out);
+    }
+}
+
+/**
+ * @brief format and print the pending messages, single consumer
+ *
+ * @param out           output stream
+ * @return uint32_t     number of printed messages
+ */
+uint32_t pid_log_drain(FILE *out)
+{
+    pid_log_record_t rec;
+    uint32_t count = 0;
+
+    for (;;)
+    {
+        uint64_t pos = ring.tail;
+        pid_log_record_t *cell = &ring.cell[pos & PID_LOG_RING_MASK];
+        uint32_t seq = __atomic_load_n(&cell->turn, __ATOMIC_ACQUIRE) + (uint32_t)(pos & PID_LOG_RING_MASK);
+
+        if (seq != (uint32_t)(pos + 1))
+            break;
+
+        memcpy(&rec, cell, sizeof(rec));
+        __atomic_store_n(&cell->turn, (uint32_t)(pos + PID_LOG_RING_SIZE) - (uint32_t)(pos & PID_LOG_RING_MASK),
+                         __ATOMIC_RELEASE);
+        ring.tail = pos + 1;
+
+        if (out)
+            pid_log_print(out, &rec);
+        count++;
+    }
+
+    if (out && count)
+        fflush(out);
+    return count;
+}
+
+/**
+ * @brief number of messages dropped because the ring was full
+ *
+ * @return uint64_t
+ */
+uint64_t pid_log_dropped(void)
+{
+    return __atomic_load_n(&ring.dropped, __ATOMIC_RELAXED);
+}
+
+static void *pid_log_thread(void *arg)
+{
+    struct timespec ts;
+
+    (void)arg;
+    ts.tv_sec = worker.period_ms / 1000U;
+    ts.tv_nsec = (long)(worker.period_ms % 1000U) * 1000000L;
+
+    while (__atomic_load_n(&worker.running, __ATOMIC_ACQUIRE))
+    {
+        pid_log_drain(worker.out);
+        nanosleep(&ts, NULL);
+    }
+    pid_log_drain(worker.out);
+    return NULL;
+}
+
+/**
+ * @brief start a background thread draining the ring to out
+ *
+ * @param out           output stream
+ * @param period_ms     drain period
+ * @return int          0 on success
+ */
+int pid_log_start(FILE *out, uint32_t period_ms)
+{
+    if (__atomic_load_n(&worker.running, __ATOMIC_ACQUIRE))
+        return -1;
+
+    worker.out = out;
+    worker.period_ms = period_ms ? period_ms : 1U;
+    __atomic_store_n(&worker.running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&worker.thread, NULL, pid_log_thread, NULL) != 0)
+    {
+        __atomic_store_n(&worker.running, 0, __ATOMIC_RELEASE);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief stop the background thread, the pending messages are drained
+ */
+void pid_log_stop(void)
+{
+    if (__atomic_exchange_n(&worker.running, 0, __ATOMIC_ACQ_REL))
+        pthread_join(worker.thread, NULL);
+}
@@ -0,0 +1,208 @@
+/**
+ * @file pid-log.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief deferred binary logging
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * The logging call only stores the address of a static message site (level,
+ * file, line, format) and up to PID_LOG_MAX_ARGS raw arguments into a lock
+ * free ring. The formatting is done later by pid_log_drain(), from the
+ * background thread started with pid_log_start() or from an idle hook.
+ *
+ * Messages above PID_LOG_LEVEL are removed at compile time. Define
+ * PID_LOG_LEVEL before including any pid header to change it per file.
+ *
+ * %s arguments are stored as pointers, only pass strings which are still
+ * valid when the ring is drained (eg: string literals).
+ */
+#ifndef __PID_LOG_H__
+#define __PID_LOG_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PID_LOG_LEVEL_NONE (-1)
+#define PID_LOG_LEVEL_ERROR (0)
+#define PID_LOG_LEVEL_WARN (1)
+#define PID_LOG_LEVEL_INFO (2)
+#define PID_LOG_LEVEL_DEBUG (3)
+
+#ifndef PID_LOG_LEVEL
+#ifdef USE_DEBUG
+#define PID_LOG_LEVEL PID_LOG_LEVEL_DEBUG
+#else
+#define PID_LOG_LEVEL PID_LOG_LEVEL_WARN
+#endif
+#endif
+
+#define PID_LOG_MAX_ARGS (4U)
+#define PID_LOG_RING_SIZE (1024U) // must be a power of 2
+
+    /**
+     * @brief static description of a logging call, its address is the message id
+     */
+    typedef struct _pid_log_site_t
+    {
+        int level;
+        int line;
+        const char *file;
+        const char *fmt;
+    } pid_log_site_t;
+
+    /**
+     * @brief raw argument: integers are stored as int64, floating points as
+     * double bits, pointers as uintptr
+     */
+    typedef uint64_t pid_log_arg_t;
+
+    /**
+     * @brief store a message into the ring, never blocks
+     * the message is dropped if the ring is full
+     *
+     * @param site      message site
+     * @param nargs     number of valid arguments
+     */
+    void pid_log_write(const pid_log_site_t *site, uint32_t nargs,
+                       pid_log_arg_t a0, pid_log_arg_t a1, pid_log_arg_t a2, pid_log_arg_t a3);
+
+    /**
+     * @brief format and print the pending messages, single consumer
+     *
+     * @param out           output stream
+     * @return uint32_t     number of printed messages
+     */
+    uint32_t pid_log_drain(FILE *out);
+
+    /**
+     * @brief number of messages dropped because the ring was full
+     *
+     * @return uint64_t
+     */
+    uint64_t pid_log_dropped(void);
+
+    /**
+     * @brief start a background thread draining the ring to out
+     *
+     * @param out           output stream
+     * @param period_ms     drain period
+     * @return int          0 on success
+     */
+    int pid_log_start(FILE *out, uint32_t period_ms);
+
+    /**
+     * @brief stop the background thread, the pending messages are drained
+     */
+    void pid_log_stop(void);
+
+    static inline pid_log_arg_t pid_log_arg_i(int64_t v)
+    {
+        return (pid_log_arg_t)v;
+    }
+
+    static inline pid_log_arg_t pid_log_arg_f(double v)
+    {
+        pid_log_arg_t a;
+        memcpy(&a, &v, sizeof(a));
+        return a;
+    }
+
+    static inline pid_log_arg_t pid_log_arg_p(const volatile void *v)
+    {
+        return (pid_log_arg_t)(uintptr_t)v;
+    }
+
+#ifdef __cplusplus
+}
+
+// the pid headers may include this file from an extern "C" block
+extern "C++"
+{
+    static inline pid_log_arg_t pid_log_arg(float v) { return pid_log_arg_f(v); }
+    static inline pid_log_arg_t pid_log_arg(double v) { return pid_log_arg_f(v); }
+    static inline pid_log_arg_t pid_log_arg(const char *v) { return pid_log_arg_p(v); }
+    static inline pid_log_arg_t pid_log_arg(const void *v) { return pid_log_arg_p(v); }
+    template <typename T>
+    static inline pid_log_arg_t pid_log_arg(T *v) { return pid_log_arg_p((const void *)v); }
+    template <typename T>
+    static inline pid_log_arg_t pid_log_arg(T v) { return pid_log_arg_i((int64_t)v); }
+}
+#define PID_LOG_ARG(x) pid_log_arg(x)
+#else
+// the default association takes integers only, any other object pointer is
+// passed through PID_LOG_PTR() so that it is not converted to an integer
+#define PID_LOG_ARG(x) _Generic((x),                         \
+                                float: pid_log_arg_f,                \
+                                double: pid_log_arg_f,               \
+                                char *: pid_log_arg_p,               \
+                                const char *: pid_log_arg_p,         \
+                                void *: pid_log_arg_p,               \
+                                const void *: pid_log_arg_p,         \
+                                volatile void *: pid_log_arg_p,      \
+                                const volatile void *: pid_log_arg_p, \
+                                default: pid_log_arg_i)(x)
+#endif
+
+/**
+ * @brief %p argument of any object pointer type, eg: PID_LOGD("%p\n", PID_LOG_PTR(pid))
+ */
+#define PID_LOG_PTR(p) ((const volatile void *)(p))
+
+// the format is counted with the arguments, so that __VA_ARGS__ is never empty
+#define PID_LOG_SELECT_(_1, _2, _3, _4, _5, N, ...) N
+#define PID_LOG_FORMAT_(...) PID_LOG_FORMAT1_(__VA_ARGS__, _)
+#define PID_LOG_FORMAT1_(f, ...) f
+#define PID_LOG_NARGS_(...) PID_LOG_SELECT_(__VA_ARGS__, 4, 3, 2, 1, 0, _)
+#define PID_LOG_ARGS0_(f) 0, 0, 0, 0
+#define PID_LOG_ARGS1_(f, a) PID_LOG_ARG(a), 0, 0, 0
+#define PID_LOG_ARGS2_(f, a, b) PID_LOG_ARG(a), PID_LOG_ARG(b), 0, 0
+#define PID_LOG_ARGS3_(f, a, b, c) PID_LOG_ARG(a), PID_LOG_ARG(b), PID_LOG_ARG(c), 0
+#define PID_LOG_ARGS4_(f, a, b, c, d) PID_LOG_ARG(a), PID_LOG_ARG(b), PID_LOG_ARG(c), PID_LOG_ARG(d)
+#define PID_LOG_ARGS_(...) PID_LOG_SELECT_(__VA_ARGS__, PID_LOG_ARGS4_, PID_LOG_ARGS3_, PID_LOG_ARGS2_, \
+                                           PID_LOG_ARGS1_, PID_LOG_ARGS0_, _)(__VA_ARGS__)
+
+#define PID_LOG_AT(lvl, ...)                                                                              \
+    do                                                                                                    \
+    {                                                                                                     \
+        static const pid_log_site_t pid_log_site_ = {lvl, __LINE__, __FILE__, PID_LOG_FORMAT_(__VA_ARGS__)}; \
+        pid_log_write(&pid_log_site_, PID_LOG_NARGS_(__VA_ARGS__), PID_LOG_ARGS_(__VA_ARGS__));             \
+    } while (0)
+
+#define PID_LOG_NOTHING_(...) \
+    do                        \
+    {                         \
+    } while (0)
+
+#if PID_LOG_LEVEL >= PID_LOG_LEVEL_ERROR
+#define PID_LOGE(...) PID_LOG_AT(PID_LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define PID_LOGE(...) PID_LOG_NOTHING_(__VA_ARGS__)
+#endif
+
+#if PID_LOG_LEVEL >= PID_LOG_LEVEL_WARN
+#define PID_LOGW(...) PID_LOG_AT(PID_LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define PID_LOGW(...) PID_LOG_NOTHING_(__VA_ARGS__)
+#endif
+
+#if PID_LOG_LEVEL >= PID_LOG_LEVEL_INFO
+#define PID_LOGI(...) PID_LOG_AT(PID_LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define PID_LOGI(...) PID_LOG_NOTHING_(__VA_ARGS__)
+#endif
+
+#if PID_LOG_LEVEL >= PID_LOG_LEVEL_DEBUG
+#define PID_LOGD(...) PID_LOG_AT(PID_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define PID_LOGD(...) PID_LOG_NOTHING_(__VA_ARGS__)
+#endif
+
+#endif // __PID_LOG_H__
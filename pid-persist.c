@@ -0,0 +1,348 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "pid-persist.h"
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+
+static int pid_persist_eeprom_write(void *ctx, uint32_t addr, const uint8_t *data, size_t size)
+{
+    const pid_eeprom_dev_t *dev = (const pid_eeprom_dev_t *)ctx;
+
+    if (!dev || !dev->write_f || !data)
+        return -1;
+
+    // the device functions do not return a status, the bytes are read back
+    eeprom_dev_write_data(dev, addr, data, size);
+    if (dev->read_f)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            if (dev->read_f(addr + (uint32_t)i) != data[i])
+                return -1;
+        }
+    }
+    return 0;
+}
+
+static int pid_persist_eeprom_read(void *ctx, uint32_t addr, uint8_t *data, size_t size)
+{
+    const pid_eeprom_dev_t *dev = (const pid_eeprom_dev_t *)ctx;
+
+    if (!dev || !dev->read_f || !data)
+        return -1;
+
+    eeprom_dev_read_data(dev, addr, data, size);
+    return 0;
+}
+
+/**
+ * @brief backend writing to an eeprom device, ctx is a pid_eeprom_dev_t
+ * A write fails if the device has no write function or if the bytes read
+ * back differ, a read fails if the device has no read function
+ * 
+ * @param backend 
+ * @param dev           eeprom device, must outlive the backend
+ */
+void pid_persist_eeprom_backend(pid_persist_backend_t *backend, pid_eeprom_dev_t *dev)
+{
+    if (!backend)
+        return;
+    backend->write_f = pid_persist_eeprom_write;
+    backend->read_f = pid_persist_eeprom_read;
+    backend->ctx = dev;
+}
+
+/**
+ * @brief create a persistence context
+ * 
+ * @param ps 
+ * @param backend       storage backend
+ * @param count         number of pid handlers (slots)
+ * @param base_addr     address of slot 0
+ * @param stride        address distance between two slots, 0 for sizeof(pid_handle_t)
+ * @return pid_result_t 
+ */
+pid_result_t pid_persist_create(pid_persist_t *ps, const pid_persist_backend_t *backend, size_t count,
+                                uint32_t base_addr, uint32_t stride)
+{
+    size_t ring_size = 1;
+
+    PID_RETURN_IF_NULL(ps);
+    PID_RETURN_IF_NULL(backend);
+    if (!backend->write_f || !count || (count > UINT32_MAX) ||
+        (stride && (stride < sizeof(pid_handle_t))))
+        return PID_ERROR;
+
+    memset(ps, 0, sizeof(pid_persist_t));
+    memcpy(&ps->backend, backend, sizeof(pid_persist_backend_t));
+    ps->count = count;
+    ps->base_addr = base_addr;
+    ps->stride = stride ? stride : (uint32_t)sizeof(pid_handle_t);
+
+    // a slot is at most once in the ring: count entries are enough
+    while (ring_size < count)
+        ring_size <<= 1;
+    ps->mask = (uint32_t)(ring_size - 1);
+
+    ps->slot = (pid_persist_slot_t *)calloc(count, sizeof(pid_persist_slot_t));
+    ps->ring = (uint32_t *)calloc(ring_size, sizeof(uint32_t));
+    if (!ps->slot || !ps->ring)
+    {
+        PID_LOG("can not allocate %u persistence slots\n", (unsigned)count);
+        free(ps->slot);
+        free(ps->ring);
+        ps->slot = NULL;
+        ps->ring = NULL;
+        return PID_ERR_MEM;
+    }
+
+    pthread_mutex_init(&ps->lock, NULL);
+    pthread_cond_init(&ps->wake, NULL);
+    pthread_cond_init(&ps->done, NULL);
+    return PID_OK;
+}
+
+/**
+ * @brief queue a save of pid into a slot, O(1), never blocks
+ * 
+ * @param ps 
+ * @param index         slot index
+ * @param pid 
+ * @return pid_result_t 
+ */
+pid_result_t pid_persist_save(pid_persist_t *ps, size_t index, const pid_handle_t *pid)
+{
+    pid_persist_slot_t *slot;
+    uint64_t head;
+
+    PID_RETURN_IF_NULL(ps);
+    PID_RETURN_IF_NULL(pid);
+    if (index >= ps->count)
+        return PID_ERROR;
+
+    slot = &ps->slot[index];
+    __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&slot->image, pid, sizeof(pid_handle_t));
+    __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&ps->saves, 1, __ATOMIC_RELAXED);
+
+    // already queued: the pending write takes the image above
+    if (__atomic_exchange_n(&slot->queued, 1, __ATOMIC_SEQ_CST))
+    {
+        __atomic_add_fetch(&ps->coalesced, 1, __ATOMIC_RELAXED);
+        return PID_OK;
+    }
+
+    head = ps->head;
+    ps->ring[head & ps->mask] = (uint32_t)index;
+    __atomic_store_n(&ps->head, head + 1, __ATOMIC_RELEASE);
+    return PID_OK;
+}
+
+/**
+ * @brief consistent copy of the image of a slot
+ * 
+ * @param slot 
+ * @param image 
+ */
+static void pid_persist_copy(pid_persist_slot_t *slot, pid_handle_t *image)
+{
+    uint32_t seq;
+
+    for (;;)
+    {
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1U)
+            continue;
+        memcpy(image, &slot->image, sizeof(pid_handle_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq)
+            return;
+    }
+}
+
+/**
+ * @brief write the queued slots, from an idle hook when no worker is started
+ * 
+ * @param ps 
+ * @param max           maximum number of writes, 0 for all
+ * @return size_t       number of processed slots
+ */
+size_t pid_persist_poll(pid_persist_t *ps, size_t max)
+{
+    pid_handle_t image;
+    size_t n = 0;
+
+    if (!ps || !ps->slot)
+        return 0;
+
+    while (!max || (n < max))
+    {
+        uint64_t tail = ps->tail;
+        uint32_t index;
+
+        if (tail == __atomic_load_n(&ps->head, __ATOMIC_ACQUIRE))
+            break;
+        index = ps->ring[tail & ps->mask];
+
+        // unqueue before the copy: a save after this point queues the slot again
+        __atomic_store_n(&ps->slot[index].queued, 0, __ATOMIC_SEQ_CST);
+        pid_persist_copy(&ps->slot[index], &image);
+        image.armed.step = NULL;
+        image.armed.block = NULL;
+
+        if (ps->backend.write_f(ps->backend.ctx, ps->base_addr + (uint32_t)index * ps->stride,
+                                (const uint8_t *)&image, sizeof(pid_handle_t)) == 0)
+            __atomic_add_fetch(&ps->written, 1, __ATOMIC_RELAXED);
+        else
+            __atomic_add_fetch(&ps->failed, 1, __ATOMIC_RELAXED);
+
+        __atomic_store_n(&ps->tail, tail + 1, __ATOMIC_RELEASE);
+        n++;
+    }
+    return n;
+}
+
+static void *pid_persist_thread(void *arg)
+{
+    pid_persist_t *ps = (pid_persist_t *)arg;
+    struct timespec ts;
+
+    pthread_mutex_lock(&ps->lock);
+    while (__atomic_load_n(&ps->running, __ATOMIC_ACQUIRE))
+    {
+        // the backend is called without the lock, flush only waits for it
+        pthread_mutex_unlock(&ps->lock);
+        pid_persist_poll(ps, 0);
+        pthread_mutex_lock(&ps->lock);
+        pthread_cond_broadcast(&ps->done);
+
+        if (ps->tail != __atomic_load_n(&ps->head, __ATOMIC_ACQUIRE))
+            continue;
+
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += ps->period_ms / 1000U;
+        ts.tv_nsec += (long)(ps->period_ms % 1000U) * 1000000L;
+        if (ts.tv_nsec >= 1000000000L)
+        {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        if (__atomic_load_n(&ps->running, __ATOMIC_ACQUIRE))
+            pthread_cond_timedwait(&ps->wake, &ps->lock, &ts);
+    }
+    pthread_mutex_unlock(&ps->lock);
+    pid_persist_poll(ps, 0);
+    return NULL;
+}
+
+/**
+ * @brief start the worker thread
+ * 
+ * @param ps 
+ * @param period_ms     maximum sleep of the worker between two polls
+ * @return pid_result_t 
+ */
+pid_result_t pid_persist_start(pid_persist_t *ps, uint32_t period_ms)
+{
+    PID_RETURN_IF_NULL(ps);
+    if (!ps->slot || __atomic_load_n(&ps->running, __ATOMIC_ACQUIRE))
+        return PID_ERROR;
+
+    ps->period_ms = period_ms ? period_ms : 1U;
+    __atomic_store_n(&ps->running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&ps->thread, NULL, pid_persist_thread, ps) != 0)
+    {
+        __atomic_store_n(&ps->running, 0, __ATOMIC_RELEASE);
+        PID_LOG("can not start the persistence worker, errno %d\n", errno);
+        return PID_ERROR;
+    }
+    return PID_OK;
+}
+
+/**
+ * @brief barrier: wait until every save queued before the call is written
+ * 
+ * @param ps 
+ * @return pid_result_t PID_ERROR if a write failed since the creation
+ */
+pid_result_t pid_persist_flush(pid_persist_t *ps)
+{
+    uint64_t target;
+
+    PID_RETURN_IF_NULL(ps);
+    if (!ps->slot)
+        return PID_ERROR;
+
+    target = __atomic_load_n(&ps->head, __ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&ps->running, __ATOMIC_ACQUIRE))
+    {
+        pthread_mutex_lock(&ps->lock);
+        pthread_cond_signal(&ps->wake);
+        while (__atomic_load_n(&ps->tail, __ATOMIC_ACQUIRE) < target)
+            pthread_cond_wait(&ps->done, &ps->lock);
+        pthread_mutex_unlock(&ps->lock);
+    }
+    else
+    {
+        while (__atomic_load_n(&ps->tail, __ATOMIC_ACQUIRE) < target)
+            pid_persist_poll(ps, 0);
+    }
+    return __atomic_load_n(&ps->failed, __ATOMIC_RELAXED) ? PID_ERROR : PID_OK;
+}
+
+/**
+ * @brief read a slot from the backend, synchronous
+ * 
+ * @param ps 
+ * @param index 
+ * @param pid 
+ * @return pid_result_t 
+ */
+pid_result_t pid_persist_load(pid_persist_t *ps, size_t index, pid_handle_t *pid)
+{
+    PID_RETURN_IF_NULL(ps);
+    PID_RETURN_IF_NULL(pid);
+    if ((index >= ps->count) || !ps->backend.read_f)
+        return PID_ERROR;
+
+    if (ps->backend.read_f(ps->backend.ctx, ps->base_addr + (uint32_t)index * ps->stride,
+                           (uint8_t *)pid, sizeof(pid_handle_t)) != 0)
+        return PID_ERROR;
+
+    // the stored step function pointers are not valid anymore
+    pid->armed.step = NULL;
+    pid->armed.block = NULL;
+    return PID_OK;
+}
+
+/**
+ * @brief flush, stop the worker and release the context
+ * 
+ * @param ps 
+ */
+void pid_persist_destroy(pid_persist_t *ps)
+{
+    if (!ps || !ps->slot)
+        return;
+
+    pid_persist_flush(ps);
+    if (__atomic_exchange_n(&ps->running, 0, __ATOMIC_ACQ_REL))
+    {
+        pthread_mutex_lock(&ps->lock);
+        pthread_cond_signal(&ps->wake);
+        pthread_mutex_unlock(&ps->lock);
+        pthread_join(ps->thread, NULL);
+    }
+
+    pthread_cond_destroy(&ps->done);
+    pthread_cond_destroy(&ps->wake);
+    pthread_mutex_destroy(&ps->lock);
+    free(ps->slot);
+    free(ps->ring);
+    ps->slot = NULL;
+    ps->ring = NULL;
+}
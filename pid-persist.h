@@ -0,0 +1,163 @@
+/**
+ * @file pid-persist.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief write-behind persistence of pid handlers
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * A persistence context owns one storage backend and one slot per pid
+ * handler. pid_persist_save() copies the handler into the staging image of
+ * its slot (seqlock) and queues the slot index in a ring, unless the slot is
+ * already queued: several saves before the write are coalesced into one
+ * write of the latest image. It never blocks and never calls the backend.
+ *
+ * The queued slots are written by the worker thread (pid_persist_start) or
+ * by pid_persist_poll() from an idle hook. pid_persist_flush() waits until
+ * every save done before the call is written, eg: before a shutdown.
+ *
+ * One thread saves into a context (the control thread), the ring has room
+ * for every slot so a save never fails for lack of space.
+ */
+#ifndef __PID_PERSIST_H__
+#define __PID_PERSIST_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "pid-eeprom.h"
+
+    /**
+     * @brief storage backend
+     * @param ctx       backend context, eg: a pid_eeprom_dev_t, a file, a flash driver
+     * @return int      0 on success
+     */
+    typedef int (*pid_persist_write_f)(void *ctx, uint32_t addr, const uint8_t *data, size_t size);
+    typedef int (*pid_persist_read_f)(void *ctx, uint32_t addr, uint8_t *data, size_t size);
+
+    typedef struct _pid_persist_backend_t
+    {
+        pid_persist_write_f write_f;
+        pid_persist_read_f read_f;
+        void *ctx;
+    } pid_persist_backend_t;
+
+    typedef struct _pid_persist_slot_t
+    {
+        uint32_t seq;       // seqlock of the image, odd while it is written
+        uint32_t queued;    // the slot index is in the ring
+        pid_handle_t image; // latest saved image
+    } pid_persist_slot_t;
+
+    typedef struct _pid_persist_t
+    {
+        pid_persist_backend_t backend;
+        pid_persist_slot_t *slot; // array of count slots
+        size_t count;
+        uint32_t base_addr; // address of slot 0
+        uint32_t stride;    // address distance between two slots
+
+        uint32_t *ring; // queued slot indexes
+        uint32_t mask;
+        uint64_t head; // written by the saving thread
+        uint64_t tail; // written by the writer
+
+        pthread_mutex_t lock; // worker sleep and flush
+        pthread_cond_t wake;
+        pthread_cond_t done;
+        pthread_t thread;
+        uint32_t period_ms;
+        int running;
+
+        uint64_t saves;     // pid_persist_save calls
+        uint64_t coalesced; // saves merged into an already queued write
+        uint64_t written;   // successful backend writes
+        uint64_t failed;    // failed backend writes
+    } pid_persist_t;
+
+    /**
+     * @brief backend writing to an eeprom device, ctx is a pid_eeprom_dev_t
+     * A write fails if the device has no write function or if the bytes read
+     * back differ, a read fails if the device has no read function
+     * 
+     * @param backend 
+     * @param dev           eeprom device, must outlive the backend
+     */
+    void pid_persist_eeprom_backend(pid_persist_backend_t *backend, pid_eeprom_dev_t *dev);
+
+    /**
+     * @brief create a persistence context
+     * 
+     * @param ps 
+     * @param backend       storage backend
+     * @param count         number of pid handlers (slots)
+     * @param base_addr     address of slot 0
+     * @param stride        address distance between two slots, 0 for sizeof(pid_handle_t)
+     * @return pid_result_t 
+     */
+    pid_result_t pid_persist_create(pid_persist_t *ps, const pid_persist_backend_t *backend, size_t count,
+                                    uint32_t base_addr, uint32_t stride);
+
+    /**
+     * @brief queue a save of pid into a slot, O(1), never blocks
+     * 
+     * @param ps 
+     * @param index         slot index
+     * @param pid 
+     * @return pid_result_t 
+     */
+    pid_result_t pid_persist_save(pid_persist_t *ps, size_t index, const pid_handle_t *pid);
+
+    /**
+     * @brief write the queued slots, from an idle hook when no worker is started
+     * 
+     * @param ps 
+     * @param max           maximum number of writes, 0 for all
+     * @return size_t       number of processed slots
+     */
+    size_t pid_persist_poll(pid_persist_t *ps, size_t max);
+
+    /**
+     * @brief start the worker thread
+     * 
+     * @param ps 
+     * @param period_ms     maximum sleep of the worker between two polls
+     * @return pid_result_t 
+     */
+    pid_result_t pid_persist_start(pid_persist_t *ps, uint32_t period_ms);
+
+    /**
+     * @brief barrier: wait until every save queued before the call is written
+     * 
+     * @param ps 
+     * @return pid_result_t PID_ERROR if a write failed since the creation
+     */
+    pid_result_t pid_persist_flush(pid_persist_t *ps);
+
+    /**
+     * @brief read a slot from the backend, synchronous
+     * 
+     * @param ps 
+     * @param index 
+     * @param pid 
+     * @return pid_result_t 
+     */
+    pid_result_t pid_persist_load(pid_persist_t *ps, size_t index, pid_handle_t *pid);
+
+    /**
+     * @brief flush, stop the worker and release the context
+     * 
+     * @param ps 
+     */
+    void pid_persist_destroy(pid_persist_t *ps);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __PID_PERSIST_H__
@@ -0,0 +1,261 @@
+#include "pid-profile.h"
+#include <stdlib.h>
+#include <math.h>
+
+/**
+ * @brief compile a recipe into a segment table
+ * 
+ * @param profile 
+ * @param step          array of count recipe steps
+ * @param count 
+ * @param start_sv      setpoint before the first step
+ * @param sample_time   tick period of the loops playing the profile, in seconds
+ * @return pid_result_t 
+ */
+pid_result_t pid_profile_compile(pid_profile_t *profile, const pid_profile_step_t *step, size_t count,
+                                 float start_sv, float sample_time)
+{
+    pid_profile_segment_t *seg;
+    double sv = start_sv, ticks;
+
+    PID_RETURN_IF_NULL(profile);
+    PID_RETURN_IF_NULL(step);
+    memset(profile, 0, sizeof(pid_profile_t));
+    if (!count || (count > UINT32_MAX) || !(sample_time > 0))
+        return PID_ERROR;
+
+    seg = (pid_profile_segment_t *)calloc(count, sizeof(pid_profile_segment_t));
+    if (!seg)
+    {
+        PID_LOG("can not allocate %u profile segments\n", (unsigned)count);
+        return PID_ERR_MEM;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const pid_profile_step_t *s = &step[i];
+        double target = s->target;
+
+        if (!(s->band >= 0))
+            goto invalid;
+
+        switch (s->type)
+        {
+        case PID_PROFILE_RAMP_RATE:
+            if (!(s->rate > 0))
+                goto invalid;
+            ticks = ceil(fabs(target - sv) / ((double)s->rate / 60.0 * sample_time));
+            break;
+        case PID_PROFILE_RAMP_TIME:
+            if (!(s->duration >= 0))
+                goto invalid;
+            ticks = round((double)s->duration / sample_time);
+            break;
+        case PID_PROFILE_SOAK:
+            if (!(s->duration >= 0))
+                goto invalid;
+            ticks = round((double)s->duration / sample_time);
+            target = sv;
+            break;
+        case PID_PROFILE_STEP:
+            ticks = 1;
+            break;
+        default:
+            goto invalid;
+        }
+
+        if (ticks < 1)
+            ticks = 1;
+        if (ticks > UINT32_MAX)
+            goto invalid;
+
+        seg[i].start = (float)sv;
+        seg[i].slope = (float)((target - sv) / ticks);
+        seg[i].end = (float)target;
+        seg[i].band = s->band;
+        seg[i].ticks = (uint32_t)ticks;
+        seg[i].offset = profile->ticks;
+        profile->ticks += seg[i].ticks;
+        sv = target;
+    }
+
+    profile->segment = seg;
+    profile->count = (uint32_t)count;
+    profile->sample_time = sample_time;
+    return PID_OK;
+
+invalid:
+    PID_LOG("invalid profile step\n");
+    free(seg);
+    profile->ticks = 0;
+    return PID_ERROR;
+}
+
+/**
+ * @brief release the segment table
+ * 
+ * @param profile 
+ */
+void pid_profile_destroy(pid_profile_t *profile)
+{
+    if (profile)
+    {
+        free(profile->segment);
+        profile->segment = NULL;
+        profile->count = 0;
+        profile->ticks = 0;
+    }
+}
+
+/**
+ * @brief start a profile from its first segment, control.sv is set to the start value
+ * 
+ * @param player 
+ * @param profile       compiled profile, must outlive the player
+ * @param pid           handler driven by the player
+ * @return pid_result_t 
+ */
+pid_result_t pid_profile_start(pid_profile_player_t *player, const pid_profile_t *profile, pid_handle_t *pid)
+{
+    PID_RETURN_IF_NULL(player);
+    PID_RETURN_IF_NULL(profile);
+    PID_RETURN_IF_NULL(pid);
+    if (!profile->segment || !profile->count)
+        return PID_ERROR;
+
+    memset(player, 0, sizeof(pid_profile_player_t));
+    player->profile = profile;
+    player->state = PID_PROFILE_RUNNING;
+    pid->control.sv = profile->segment[0].start;
+    return PID_OK;
+}
+
+/**
+ * @brief pause a running player, the setpoint is held
+ * 
+ * @param player 
+ * @return pid_result_t PID_ERROR if the player is not running
+ */
+pid_result_t pid_profile_pause(pid_profile_player_t *player)
+{
+    PID_RETURN_IF_NULL(player);
+    if ((player->state != PID_PROFILE_RUNNING) && (player->state != PID_PROFILE_HOLDING))
+        return PID_ERROR;
+
+    player->resume = player->state;
+    player->state = PID_PROFILE_PAUSED;
+    return PID_OK;
+}
+
+/**
+ * @brief resume a paused player
+ * 
+ * @param player 
+ * @return pid_result_t PID_ERROR if the player is not paused
+ */
+pid_result_t pid_profile_resume(pid_profile_player_t *player)
+{
+    PID_RETURN_IF_NULL(player);
+    if (player->state != PID_PROFILE_PAUSED)
+        return PID_ERROR;
+
+    player->state = player->resume;
+    return PID_OK;
+}
+
+/**
+ * @brief stop a player, the setpoint keeps its value
+ * 
+ * @param player 
+ */
+void pid_profile_stop(pid_profile_player_t *player)
+{
+    if (player)
+        player->state = PID_PROFILE_IDLE;
+}
+
+/**
+ * @brief advance the player by one tick and write control.sv, O(1)
+ * 
+ * @param player 
+ * @param pid 
+ * @return pid_profile_state_e  state after the tick
+ */
+pid_profile_state_e pid_profile_advance(pid_profile_player_t *player, pid_handle_t *pid)
+{
+    const pid_profile_segment_t *seg;
+    float dev;
+
+    if ((player->state != PID_PROFILE_RUNNING) && (player->state != PID_PROFILE_HOLDING))
+        return (pid_profile_state_e)player->state;
+
+    seg = &player->profile->segment[player->segment];
+
+    // holdback / guaranteed soak, against the pv of the last tick
+    dev = pid->control.sv - pid->control.pv.value;
+    if ((seg->band > 0) && ((dev > seg->band) || (dev < -seg->band)))
+    {
+        player->state = PID_PROFILE_HOLDING;
+        player->held++;
+        return PID_PROFILE_HOLDING;
+    }
+
+    player->state = PID_PROFILE_RUNNING;
+    if (++player->tick < seg->ticks)
+    {
+        pid->control.sv = seg->start + seg->slope * (float)player->tick;
+        return PID_PROFILE_RUNNING;
+    }
+
+    pid->control.sv = seg->end;
+    player->tick = 0;
+    if (++player->segment == player->profile->count)
+    {
+        player->segment--;
+        player->tick = seg->ticks;
+        player->state = PID_PROFILE_DONE;
+    }
+    return (pid_profile_state_e)player->state;
+}
+
+/**
+ * @brief advance count players, player[i] drives pid[i]
+ * 
+ * @param player        array of count players
+ * @param pid           array of count handlers, eg: bank->pid
+ * @param count 
+ * @return size_t       number of players which are running or holding
+ */
+size_t pid_profile_advance_bank(pid_profile_player_t *player, pid_handle_t *pid, size_t count)
+{
+    size_t active = 0;
+
+    if (!player || !pid)
+        return 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        pid_profile_state_e state = pid_profile_advance(&player[i], &pid[i]);
+
+        if ((state == PID_PROFILE_RUNNING) || (state == PID_PROFILE_HOLDING))
+            active++;
+    }
+    return active;
+}
+
+/**
+ * @brief ticks left until the end of the profile, without holdback
+ * 
+ * @param player 
+ * @return uint64_t 
+ */
+uint64_t pid_profile_remaining(const pid_profile_player_t *player)
+{
+    const pid_profile_segment_t *seg;
+
+    if (!player || !player->profile || (player->state == PID_PROFILE_IDLE))
+        return 0;
+
+    seg = &player->profile->segment[player->segment];
+    return player->profile->ticks - seg->offset - player->tick;
+}
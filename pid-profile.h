@@ -0,0 +1,179 @@
+/**
+ * @file pid-profile.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief setpoint profiles (ramps, soaks, recipes)
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * A recipe is compiled once into a table of segments counted in ticks:
+ * sv = start + slope * tick, the last tick of a segment sets its end value
+ * exactly so the rounding does not accumulate. A player walks one loop
+ * through a compiled profile, pid_profile_advance() is O(1) and does not
+ * allocate, it is called before pid_on_processing on every tick.
+ *
+ * Every segment has a band: while |sv - pv| > band the tick of the segment
+ * does not advance. On a ramp this holds the setpoint back until the pv
+ * follows; on a soak the soak time only counts the ticks inside the band
+ * (guaranteed soak). A band of 0 disables it.
+ *
+ * Several players can share one profile, which is read only once compiled.
+ */
+#ifndef __PID_PROFILE_H__
+#define __PID_PROFILE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pid.h"
+
+    typedef enum _pid_profile_step_type_e
+    {
+        PID_PROFILE_RAMP_RATE = 0, // ramp to target at rate units per minute
+        PID_PROFILE_RAMP_TIME,     // ramp to target in duration seconds
+        PID_PROFILE_SOAK,          // hold the setpoint for duration seconds
+        PID_PROFILE_STEP,          // jump to target
+        PID_PROFILE_STEP_MAX,
+    } pid_profile_step_type_e;
+
+    /**
+     * @brief one step of a recipe, as written by the user
+     */
+    typedef struct _pid_profile_step_t
+    {
+        pid_profile_step_type_e type;
+        float target;   // setpoint at the end of the step (ramps, step)
+        float rate;     // units per minute (PID_PROFILE_RAMP_RATE)
+        float duration; // seconds (PID_PROFILE_RAMP_TIME, PID_PROFILE_SOAK)
+        float band;     // holdback / guaranteed soak band, 0 to disable
+    } pid_profile_step_t;
+
+    /**
+     * @brief one compiled segment
+     */
+    typedef struct _pid_profile_segment_t
+    {
+        float start; // sv on tick 0
+        float slope; // sv change per tick
+        float end;   // sv on the last tick
+        float band;  // |sv - pv| above which the segment does not advance
+        uint32_t ticks;  // duration, >= 1
+        uint64_t offset; // ticks of the previous segments
+    } pid_profile_segment_t;
+
+    typedef struct _pid_profile_t
+    {
+        pid_profile_segment_t *segment;
+        uint32_t count;
+        float sample_time; // tick period the profile was compiled for
+        uint64_t ticks;    // duration without holdback
+    } pid_profile_t;
+
+    typedef enum _pid_profile_state_e
+    {
+        PID_PROFILE_IDLE = 0,
+        PID_PROFILE_RUNNING,
+        PID_PROFILE_HOLDING, // holdback / guaranteed soak: the pv is out of band
+        PID_PROFILE_PAUSED,  // paused by the user, the setpoint is held
+        PID_PROFILE_DONE,    // the last segment is complete, the setpoint keeps its end value
+    } pid_profile_state_e;
+
+    typedef struct _pid_profile_player_t
+    {
+        const pid_profile_t *profile;
+        uint32_t segment; // current segment
+        uint32_t tick;    // tick inside the current segment
+        uint8_t state;    // pid_profile_state_e
+        uint8_t resume;   // state restored by pid_profile_resume
+        uint64_t held;    // ticks spent in PID_PROFILE_HOLDING
+    } pid_profile_player_t;
+
+    /**
+     * @brief compile a recipe into a segment table
+     * 
+     * @param profile 
+     * @param step          array of count recipe steps
+     * @param count 
+     * @param start_sv      setpoint before the first step
+     * @param sample_time   tick period of the loops playing the profile, in seconds
+     * @return pid_result_t 
+     */
+    pid_result_t pid_profile_compile(pid_profile_t *profile, const pid_profile_step_t *step, size_t count,
+                                     float start_sv, float sample_time);
+
+    /**
+     * @brief release the segment table
+     * 
+     * @param profile 
+     */
+    void pid_profile_destroy(pid_profile_t *profile);
+
+    /**
+     * @brief start a profile from its first segment, control.sv is set to the start value
+     * 
+     * @param player 
+     * @param profile       compiled profile, must outlive the player
+     * @param pid           handler driven by the player
+     * @return pid_result_t 
+     */
+    pid_result_t pid_profile_start(pid_profile_player_t *player, const pid_profile_t *profile, pid_handle_t *pid);
+
+    /**
+     * @brief pause a running player, the setpoint is held
+     * 
+     * @param player 
+     * @return pid_result_t PID_ERROR if the player is not running
+     */
+    pid_result_t pid_profile_pause(pid_profile_player_t *player);
+
+    /**
+     * @brief resume a paused player
+     * 
+     * @param player 
+     * @return pid_result_t PID_ERROR if the player is not paused
+     */
+    pid_result_t pid_profile_resume(pid_profile_player_t *player);
+
+    /**
+     * @brief stop a player, the setpoint keeps its value
+     * 
+     * @param player 
+     */
+    void pid_profile_stop(pid_profile_player_t *player);
+
+    /**
+     * @brief advance the player by one tick and write control.sv, O(1)
+     * 
+     * @param player 
+     * @param pid 
+     * @return pid_profile_state_e  state after the tick
+     */
+    pid_profile_state_e pid_profile_advance(pid_profile_player_t *player, pid_handle_t *pid);
+
+    /**
+     * @brief advance count players, player[i] drives pid[i]
+     * 
+     * @param player        array of count players
+     * @param pid           array of count handlers, eg: bank->pid
+     * @param count 
+     * @return size_t       number of players which are running or holding
+     */
+    size_t pid_profile_advance_bank(pid_profile_player_t *player, pid_handle_t *pid, size_t count);
+
+    /**
+     * @brief ticks left until the end of the profile, without holdback
+     * 
+     * @param player 
+     * @return uint64_t 
+     */
+    uint64_t pid_profile_remaining(const pid_profile_player_t *player);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __PID_PROFILE_H__
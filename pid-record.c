@@ -0,0 +1,318 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "pid-record.h"
+#include <stdlib.h>
+#include <time.h>
+#include "pid-io.h"
+
+static uint64_t record_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline bool record_same(float a, float b)
+{
+    return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+static void pid_record_write(pid_recorder_t *rec, pid_record_entry_t *entry)
+{
+    entry->time_us = (record_now_ns() - rec->start_ns) / 1000U;
+    if (fwrite(entry, sizeof(pid_record_entry_t), 1, rec->file) == 1)
+        rec->count++;
+}
+
+/**
+ * @brief start a recording, the current configuration of pid is stored
+ * 
+ * @param rec 
+ * @param path          output file
+ * @param pid           recorded pid handler
+ * @return pid_result_t 
+ */
+pid_result_t pid_record_open(pid_recorder_t *rec, const char *path, const pid_handle_t *pid)
+{
+    pid_record_header_t header;
+    pid_handle_t config;
+
+    PID_RETURN_IF_NULL(rec);
+    PID_RETURN_IF_NULL(path);
+    PID_RETURN_IF_NULL(pid);
+
+    memset(rec, 0, sizeof(pid_recorder_t));
+    rec->file = fopen(path, "wb");
+    if (!rec->file)
+    {
+        PID_LOG("can not open the record file\n");
+        return PID_ERROR;
+    }
+    rec->buffer = (char *)malloc(PID_RECORD_BUFFER_SIZE);
+    if (rec->buffer)
+        setvbuf(rec->file, rec->buffer, _IOFBF, PID_RECORD_BUFFER_SIZE);
+
+    memset(&header, 0, sizeof(header));
+    header.magic = PID_RECORD_MAGIC;
+    header.version = PID_RECORD_VERSION;
+    header.entry_size = sizeof(pid_record_entry_t);
+    header.config_size = sizeof(pid_handle_t);
+    header.armed = (pid->armed.step != NULL);
+
+    // the step function address is only valid in this process
+    memcpy(&config, pid, sizeof(pid_handle_t));
+    config.armed.step = NULL;
+    config.armed.block = NULL;
+
+    if (fwrite(&header, sizeof(header), 1, rec->file) != 1 ||
+        fwrite(&config, sizeof(config), 1, rec->file) != 1)
+    {
+        pid_record_close(rec);
+        return PID_ERROR;
+    }
+    rec->start_ns = record_now_ns();
+    return PID_OK;
+}
+
+/**
+ * @brief io_get_pv_value() + pid_on_processing(), and record the sample
+ * 
+ * @param rec 
+ * @param pid 
+ * @param adc_value     adc value, read from input pin
+ * @return pid_result_t result of pid_on_processing
+ */
+pid_result_t pid_record_process_adc(pid_recorder_t *rec, pid_handle_t *pid, int adc_value)
+{
+    pid_record_entry_t entry;
+    pid_result_t err;
+
+    PID_RETURN_IF_NULL(rec);
+    PID_RETURN_IF_NULL(pid);
+
+    io_get_pv_value(pid, adc_value);
+    err = pid_on_processing(pid, pid->control.pv.value);
+
+    memset(&entry, 0, sizeof(entry));
+    entry.type = PID_RECORD_ADC;
+    entry.code = adc_value;
+    entry.arg[0] = pid->control.pv.value;
+    entry.arg[1] = pid->control.cv.buff[0];
+    pid_record_write(rec, &entry);
+    return err;
+}
+
+/**
+ * @brief pid_on_processing(), and record the sample
+ * 
+ * @param rec 
+ * @param pid 
+ * @param current_pv 
+ * @return pid_result_t result of pid_on_processing
+ */
+pid_result_t pid_record_process_pv(pid_recorder_t *rec, pid_handle_t *pid, float current_pv)
+{
+    pid_record_entry_t entry;
+    pid_result_t err;
+
+    PID_RETURN_IF_NULL(rec);
+    PID_RETURN_IF_NULL(pid);
+
+    err = pid_on_processing(pid, current_pv);
+
+    memset(&entry, 0, sizeof(entry));
+    entry.type = PID_RECORD_PV;
+    entry.arg[0] = current_pv;
+    entry.arg[1] = pid->control.cv.buff[0];
+    pid_record_write(rec, &entry);
+    return err;
+}
+
+/**
+ * @brief apply a configuration change, and record it
+ * 
+ * @param rec 
+ * @param pid 
+ * @param cmd 
+ * @return pid_result_t result of the setter
+ */
+pid_result_t pid_record_apply(pid_recorder_t *rec, pid_handle_t *pid, const pid_cmd_t *cmd)
+{
+    pid_record_entry_t entry;
+    pid_result_t err;
+
+    PID_RETURN_IF_NULL(rec);
+    PID_RETURN_IF_NULL(pid);
+    PID_RETURN_IF_NULL(cmd);
+
+    err = pid_server_apply_cmd(pid, cmd);
+
+    memset(&entry, 0, sizeof(entry));
+    entry.type = PID_RECORD_SETTER;
+    entry.opcode = cmd->opcode;
+    entry.code = err;
+    memcpy(entry.arg, cmd->arg, sizeof(entry.arg));
+    pid_record_write(rec, &entry);
+    return err;
+}
+
+/**
+ * @brief flush and close the recording
+ * 
+ * @param rec 
+ * @return pid_result_t PID_ERROR if a write failed
+ */
+pid_result_t pid_record_close(pid_recorder_t *rec)
+{
+    pid_result_t err = PID_OK;
+
+    PID_RETURN_IF_NULL(rec);
+    if (rec->file)
+    {
+        if (ferror(rec->file) || fclose(rec->file) != 0)
+            err = PID_ERROR;
+        rec->file = NULL;
+    }
+    free(rec->buffer);
+    rec->buffer = NULL;
+    return err;
+}
+
+/**
+ * @brief load a recording in memory
+ * 
+ * @param rp 
+ * @param path 
+ * @return pid_result_t 
+ */
+pid_result_t pid_replay_open(pid_replay_t *rp, const char *path)
+{
+    const size_t head = sizeof(pid_record_header_t) + sizeof(pid_handle_t);
+    FILE *file;
+    long size;
+
+    PID_RETURN_IF_NULL(rp);
+    PID_RETURN_IF_NULL(path);
+
+    memset(rp, 0, sizeof(pid_replay_t));
+    file = fopen(path, "rb");
+    if (!file)
+    {
+        PID_LOG("can not open the record file\n");
+        return PID_ERROR;
+    }
+
+    if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < (long)head || fseek(file, 0, SEEK_SET) != 0)
+    {
+        fclose(file);
+        return PID_ERROR;
+    }
+
+    rp->size = (size_t)size;
+    rp->data = malloc(rp->size);
+    if (!rp->data || fread(rp->data, 1, rp->size, file) != rp->size)
+    {
+        fclose(file);
+        pid_replay_close(rp);
+        return PID_ERROR;
+    }
+    fclose(file);
+
+    memcpy(&rp->header, rp->data, sizeof(pid_record_header_t));
+    if (rp->header.magic != PID_RECORD_MAGIC || rp->header.version != PID_RECORD_VERSION ||
+        rp->header.entry_size != sizeof(pid_record_entry_t) || rp->header.config_size != sizeof(pid_handle_t))
+    {
+        PID_LOG("record file from an other version or build\n");
+        pid_replay_close(rp);
+        return PID_ERROR;
+    }
+
+    memcpy(&rp->config, (uint8_t *)rp->data + sizeof(pid_record_header_t), sizeof(pid_handle_t));
+    rp->entry = (const pid_record_entry_t *)((uint8_t *)rp->data + head);
+    rp->count = (rp->size - head) / sizeof(pid_record_entry_t);
+    return PID_OK;
+}
+
+/**
+ * @brief restore the recorded configuration into pid and replay every entry
+ * 
+ * @param rp 
+ * @param pid           pid handler, overwritten by the recorded configuration
+ * @param stats         can be NULL
+ * @return pid_result_t PID_ERROR if an output differs from the recording
+ */
+pid_result_t pid_replay_run(const pid_replay_t *rp, pid_handle_t *pid, pid_replay_stats_t *stats)
+{
+    pid_replay_stats_t st;
+    pid_cmd_t cmd;
+    uint64_t start;
+    bool same;
+
+    PID_RETURN_IF_NULL(rp);
+    PID_RETURN_IF_NULL(pid);
+
+    memset(&st, 0, sizeof(st));
+    memcpy(pid, &rp->config, sizeof(pid_handle_t));
+    pid->armed.step = NULL;
+    pid->armed.block = NULL;
+    if (rp->header.armed && pid_arm(pid) != PID_OK)
+        return PID_ERROR;
+
+    memset(&cmd, 0, sizeof(cmd));
+    start = record_now_ns();
+    for (uint64_t i = 0; i < rp->count; i++)
+    {
+        const pid_record_entry_t *e = &rp->entry[i];
+
+        switch (e->type)
+        {
+        case PID_RECORD_ADC:
+            io_get_pv_value(pid, e->code);
+            pid_on_processing(pid, pid->control.pv.value);
+            same = record_same(pid->control.pv.value, e->arg[0]) && record_same(pid->control.cv.buff[0], e->arg[1]);
+            st.samples++;
+            break;
+
+        case PID_RECORD_PV:
+            pid_on_processing(pid, e->arg[0]);
+            same = record_same(pid->control.cv.buff[0], e->arg[1]);
+            st.samples++;
+            break;
+
+        case PID_RECORD_SETTER:
+            cmd.opcode = e->opcode;
+            memcpy(cmd.arg, e->arg, sizeof(cmd.arg));
+            same = (pid_server_apply_cmd(pid, &cmd) == e->code);
+            st.setters++;
+            break;
+
+        default:
+            same = false;
+            break;
+        }
+
+        if (!same && (st.mismatches++ == 0))
+            st.first_mismatch = i;
+    }
+    st.elapsed_ns = record_now_ns() - start;
+    if (rp->count)
+        st.recorded_us = rp->entry[rp->count - 1].time_us;
+
+    if (stats)
+        memcpy(stats, &st, sizeof(st));
+    return st.mismatches ? PID_ERROR : PID_OK;
+}
+
+/**
+ * @brief release the recording
+ * 
+ * @param rp 
+ */
+void pid_replay_close(pid_replay_t *rp)
+{
+    if (!rp)
+        return;
+    free(rp->data);
+    memset(rp, 0, sizeof(pid_replay_t));
+}
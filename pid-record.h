@@ -0,0 +1,169 @@
+/**
+ * @file pid-record.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief record and replay of the pv input stream of a pid handler
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * file     : pid_record_header_t + pid_handle_t image + n * pid_record_entry_t
+ *
+ * The recorder captures the configuration of the handler when the recording
+ * starts, then every adc code / pv, the resulting pv and cv, and every
+ * configuration change (as a pid_cmd_t of the command server). The replay
+ * driver feeds the stream back through io_get_pv_value() and
+ * pid_on_processing() as fast as possible and checks every output bit for
+ * bit against the recording.
+ *
+ * The file uses the host byte order and the pid_handle_t layout of the build,
+ * it is meant to be replayed by the same build (or the same architecture).
+ */
+#ifndef __PID_RECORD_H__
+#define __PID_RECORD_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include "pid-server.h"
+
+#define PID_RECORD_MAGIC (0x31435250U) // "PRC1"
+#define PID_RECORD_VERSION (2U) // 64 bit time_us
+#define PID_RECORD_BUFFER_SIZE (1U << 20)
+
+    typedef enum _pid_record_type_e
+    {
+        PID_RECORD_ADC = 0, // code: adc value, arg[0]: pv, arg[1]: cv
+        PID_RECORD_PV,      // arg[0]: pv, arg[1]: cv
+        PID_RECORD_SETTER,  // opcode, arg[0..2]: pid_cmd_t, code: result
+    } pid_record_type_e;
+
+    typedef struct _pid_record_header_t
+    {
+        uint32_t magic;       // PID_RECORD_MAGIC
+        uint16_t version;     // PID_RECORD_VERSION
+        uint16_t entry_size;  // sizeof(pid_record_entry_t)
+        uint32_t config_size; // sizeof(pid_handle_t)
+        uint32_t armed;       // the handler was armed when the recording started
+    } pid_record_header_t;
+
+    typedef struct _pid_record_entry_t
+    {
+        uint64_t time_us;  // time since the start of the recording
+        uint16_t type;     // pid_record_type_e
+        uint16_t opcode;   // pid_cmd_opcode_e of a PID_RECORD_SETTER
+        int32_t code;      // adc value or result of the setter
+        float arg[3];
+        uint32_t reserved; // tail padding of the 64 bit time_us, 0
+    } pid_record_entry_t;
+
+    typedef struct _pid_recorder_t
+    {
+        FILE *file;
+        char *buffer;      // stdio buffer
+        uint64_t start_ns; // CLOCK_MONOTONIC at the start of the recording
+        uint64_t count;    // number of recorded entries
+    } pid_recorder_t;
+
+    typedef struct _pid_replay_t
+    {
+        pid_record_header_t header;
+        pid_handle_t config;             // configuration when the recording started
+        const pid_record_entry_t *entry; // array of count entries
+        uint64_t count;
+        void *data; // whole file
+        size_t size;
+    } pid_replay_t;
+
+    typedef struct _pid_replay_stats_t
+    {
+        uint64_t samples;        // replayed adc / pv entries
+        uint64_t setters;        // replayed setters
+        uint64_t mismatches;     // entries whose pv / cv / result differs from the recording
+        uint64_t first_mismatch; // index of the first mismatching entry
+        uint64_t elapsed_ns;     // replay time
+        uint64_t recorded_us;    // time span of the recording
+    } pid_replay_stats_t;
+
+    /**
+     * @brief start a recording, the current configuration of pid is stored
+     *
+     * @param rec
+     * @param path          output file
+     * @param pid           recorded pid handler
+     * @return pid_result_t
+     */
+    pid_result_t pid_record_open(pid_recorder_t *rec, const char *path, const pid_handle_t *pid);
+
+    /**
+     * @brief io_get_pv_value() + pid_on_processing(), and record the sample
+     *
+     * @param rec
+     * @param pid
+     * @param adc_value     adc value, read from input pin
+     * @return pid_result_t result of pid_on_processing
+     */
+    pid_result_t pid_record_process_adc(pid_recorder_t *rec, pid_handle_t *pid, int adc_value);
+
+    /**
+     * @brief pid_on_processing(), and record the sample
+     *
+     * @param rec
+     * @param pid
+     * @param current_pv
+     * @return pid_result_t result of pid_on_processing
+     */
+    pid_result_t pid_record_process_pv(pid_recorder_t *rec, pid_handle_t *pid, float current_pv);
+
+    /**
+     * @brief apply a configuration change, and record it
+     *
+     * @param rec
+     * @param pid
+     * @param cmd
+     * @return pid_result_t result of the setter
+     */
+    pid_result_t pid_record_apply(pid_recorder_t *rec, pid_handle_t *pid, const pid_cmd_t *cmd);
+
+    /**
+     * @brief flush and close the recording
+     *
+     * @param rec
+     * @return pid_result_t PID_ERROR if a write failed
+     */
+    pid_result_t pid_record_close(pid_recorder_t *rec);
+
+    /**
+     * @brief load a recording in memory
+     *
+     * @param rp
+     * @param path
+     * @return pid_result_t
+     */
+    pid_result_t pid_replay_open(pid_replay_t *rp, const char *path);
+
+    /**
+     * @brief restore the recorded configuration into pid and replay every entry
+     *
+     * @param rp
+     * @param pid           pid handler, overwritten by the recorded configuration
+     * @param stats         can be NULL
+     * @return pid_result_t PID_ERROR if an output differs from the recording
+     */
+    pid_result_t pid_replay_run(const pid_replay_t *rp, pid_handle_t *pid, pid_replay_stats_t *stats);
+
+    /**
+     * @brief release the recording
+     *
+     * @param rp
+     */
+    void pid_replay_close(pid_replay_t *rp);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __PID_RECORD_H__
@@ -0,0 +1,283 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "pid-rt.h"
+#include <sched.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#define NSEC_PER_SEC (1000000000ULL)
+
+static uint64_t rt_timespec_to_ns(const struct timespec *ts)
+{
+    return (uint64_t)ts->tv_sec * NSEC_PER_SEC + (uint64_t)ts->tv_nsec;
+}
+
+static void rt_ns_to_timespec(uint64_t ns, struct timespec *ts)
+{
+    ts->tv_sec = (time_t)(ns / NSEC_PER_SEC);
+    ts->tv_nsec = (long)(ns % NSEC_PER_SEC);
+}
+
+static uint64_t rt_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return rt_timespec_to_ns(&ts);
+}
+
+/**
+ * @brief touch the stack so that the first cycles do not page fault
+ * 
+ * @param size 
+ */
+static void rt_prefault_stack(size_t size)
+{
+    volatile uint8_t buffer[PID_RT_DEFAULT_PREFAULT_STACK];
+    size_t page = 4096;
+
+    // pid_rt_start refuses a larger size
+    for (size_t i = 0; (i < size) && (i < sizeof(buffer)); i += page)
+        buffer[i] = 0;
+}
+
+/**
+ * @brief publish the statistics of the runner thread, seqlock writer side
+ * 
+ * @param runner 
+ * @param stats 
+ */
+static void rt_publish_stats(pid_rt_runner_t *runner, const pid_rt_stats_t *stats)
+{
+    __atomic_store_n(&runner->seq, runner->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&runner->stats, stats, sizeof(pid_rt_stats_t));
+    __atomic_store_n(&runner->seq, runner->seq + 1, __ATOMIC_RELEASE);
+}
+
+static void *rt_thread(void *arg)
+{
+    pid_rt_runner_t *runner = (pid_rt_runner_t *)arg;
+    pid_rt_config_t *config = &runner->config;
+    pid_rt_stats_t stats;
+    uint64_t next, now, start, missed, first, late_until = 0;
+    struct timespec ts;
+    bool hold = false;
+
+    memset(&stats, 0, sizeof(stats));
+    rt_prefault_stack(config->prefault_stack);
+
+    next = rt_now_ns() + config->period_ns;
+    while (__atomic_load_n(&runner->running, __ATOMIC_ACQUIRE))
+    {
+        // the counters of the previous cycle, published out of the timed section
+        rt_publish_stats(runner, &stats);
+
+        rt_ns_to_timespec(next, &ts);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+            ;
+
+        start = rt_now_ns();
+        if (start - next > stats.max_latency_ns)
+            stats.max_latency_ns = start - next;
+
+        if (hold)
+        {
+            if (config->hold)
+                config->hold(config->arg);
+            stats.held++;
+            hold = false;
+        }
+        else
+        {
+            config->step(config->arg);
+            stats.cycles++;
+        }
+
+        now = rt_now_ns();
+        if (now - start > stats.max_exec_ns)
+            stats.max_exec_ns = now - start;
+
+        next += config->period_ns;
+        if (now <= next)
+            continue;
+
+        // overrun: the deadlines in [next, now] are missed, the ones already
+        // counted by a previous catch up cycle are not counted again
+        missed = (now - next) / config->period_ns + 1;
+        first = (late_until >= next) ? late_until + config->period_ns : next;
+        if (now >= first)
+        {
+            stats.missed += (now - first) / config->period_ns + 1;
+            late_until = first + ((now - first) / config->period_ns) * config->period_ns;
+        }
+
+        switch (config->overrun)
+        {
+        case PID_RT_OVERRUN_CATCH_UP:
+            // the sleep returns at once until next is in the future
+            break;
+
+        case PID_RT_OVERRUN_HOLD:
+            hold = true;
+            next += missed * config->period_ns;
+            break;
+
+        case PID_RT_OVERRUN_SKIP:
+        default:
+            next += missed * config->period_ns;
+            break;
+        }
+    }
+    rt_publish_stats(runner, &stats);
+    return NULL;
+}
+
+/**
+ * @brief fill a runner configuration with the default values
+ * 
+ * @param config 
+ * @param period_ns     cycle period
+ * @param step          cycle function
+ * @param arg           argument of the cycle function
+ */
+void pid_rt_config_default(pid_rt_config_t *config, uint64_t period_ns, pid_rt_step_f step, void *arg)
+{
+    if (!config)
+        return;
+
+    memset(config, 0, sizeof(pid_rt_config_t));
+    config->period_ns = period_ns;
+    config->cpu = -1;
+    config->priority = PID_RT_DEFAULT_PRIORITY;
+    config->prefault_stack = PID_RT_DEFAULT_PREFAULT_STACK;
+    config->overrun = PID_RT_OVERRUN_SKIP;
+    config->step = step;
+    config->arg = arg;
+}
+
+/**
+ * @brief start the runner thread
+ * If the real time privileges are not available (SCHED_FIFO, mlockall),
+ * a warning is logged and the runner continues with the default scheduler,
+ * runner->realtime tells whether both were granted
+ * 
+ * @param runner 
+ * @param config 
+ * @return pid_result_t PID_ERROR if prefault_stack is above PID_RT_DEFAULT_PREFAULT_STACK
+ */
+pid_result_t pid_rt_start(pid_rt_runner_t *runner, const pid_rt_config_t *config)
+{
+    pthread_attr_t attr;
+    struct sched_param param;
+    bool locked = true, fifo;
+    int ret;
+
+    PID_RETURN_IF_NULL(runner);
+    PID_RETURN_IF_NULL(config);
+    if (!config->step || config->period_ns == 0)
+        return PID_ERROR;
+    if (config->prefault_stack > PID_RT_DEFAULT_PREFAULT_STACK)
+    {
+        PID_LOG("prefault_stack %u is above the %u bytes touched by the runner\n",
+                (unsigned)config->prefault_stack, (unsigned)PID_RT_DEFAULT_PREFAULT_STACK);
+        return PID_ERROR;
+    }
+
+    memset(runner, 0, sizeof(pid_rt_runner_t));
+    memcpy(&runner->config, config, sizeof(pid_rt_config_t));
+    fifo = (config->priority > 0);
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        PID_LOGW("mlockall failed (errno %d), memory is not locked\n", errno);
+        locked = false;
+    }
+
+    pthread_attr_init(&attr);
+    if (config->priority > 0)
+    {
+        param.sched_priority = config->priority;
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+    }
+
+    // pinned before creation, the first cycle already runs on the cpu
+    if (config->cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(config->cpu, &set);
+        if (pthread_attr_setaffinity_np(&attr, sizeof(set), &set) != 0)
+        {
+            PID_LOGW("can not pin the runner to cpu %d\n", config->cpu);
+        }
+    }
+
+    __atomic_store_n(&runner->running, 1, __ATOMIC_RELEASE);
+    ret = pthread_create(&runner->thread, &attr, rt_thread, runner);
+    if (ret == EPERM && fifo)
+    {
+        PID_LOGW("SCHED_FIFO is not permitted, runner uses the default scheduler\n");
+        fifo = false;
+        pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+        ret = pthread_create(&runner->thread, &attr, rt_thread, runner);
+    }
+    pthread_attr_destroy(&attr);
+
+    if (ret != 0)
+    {
+        PID_LOG("can not create the runner thread, error %d\n", ret);
+        __atomic_store_n(&runner->running, 0, __ATOMIC_RELEASE);
+        return PID_ERROR;
+    }
+
+    runner->realtime = locked && fifo;
+    return PID_OK;
+}
+
+/**
+ * @brief stop the runner thread and wait for it
+ * 
+ * @param runner 
+ * @return pid_result_t 
+ */
+pid_result_t pid_rt_stop(pid_rt_runner_t *runner)
+{
+    PID_RETURN_IF_NULL(runner);
+
+    if (!__atomic_exchange_n(&runner->running, 0, __ATOMIC_ACQ_REL))
+        return PID_ERROR;
+
+    pthread_join(runner->thread, NULL);
+    return PID_OK;
+}
+
+/**
+ * @brief read the runner statistics
+ * The copy is consistent, it can be taken while the runner is running
+ * 
+ * @param runner 
+ * @param stats 
+ * @return pid_result_t 
+ */
+pid_result_t pid_rt_get_stats(pid_rt_runner_t *runner, pid_rt_stats_t *stats)
+{
+    uint32_t seq;
+
+    PID_RETURN_IF_NULL(runner);
+    PID_RETURN_IF_NULL(stats);
+
+    for (;;)
+    {
+        seq = __atomic_load_n(&runner->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1U)
+            continue;
+        memcpy(stats, &runner->stats, sizeof(pid_rt_stats_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&runner->seq, __ATOMIC_RELAXED) == seq)
+            return PID_OK;
+    }
+}
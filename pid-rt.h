@@ -0,0 +1,123 @@
+/**
+ * @file pid-rt.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief 
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+#ifndef __PID_RT_H__
+#define __PID_RT_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "pid-common.h"
+
+#define PID_RT_DEFAULT_PRIORITY (80)
+#define PID_RT_DEFAULT_PREFAULT_STACK (64U * 1024U)
+
+    typedef enum _pid_rt_overrun_e
+    {
+        /**
+         * @brief the missed cycles are dropped, the runner continues on the
+         * next deadline in the future
+         */
+        PID_RT_OVERRUN_SKIP = 0,
+        /**
+         * @brief the missed cycles are executed back to back until the runner
+         * is on time again
+         */
+        PID_RT_OVERRUN_CATCH_UP,
+        /**
+         * @brief the missed cycles are dropped and the first cycle after the
+         * overrun calls hold() instead of step(), the outputs keep their value
+         */
+        PID_RT_OVERRUN_HOLD,
+    } pid_rt_overrun_e;
+
+    typedef void (*pid_rt_step_f)(void *arg);
+
+    typedef struct _pid_rt_config_t
+    {
+        uint64_t period_ns;         // cycle period
+        int cpu;                    // cpu to run on, -1 for no affinity
+        int priority;               // SCHED_FIFO priority, 0 for the default scheduler
+        size_t prefault_stack;      // bytes of stack touched before the first cycle, at most PID_RT_DEFAULT_PREFAULT_STACK
+        pid_rt_overrun_e overrun;   // overrun policy
+        pid_rt_step_f step;         // cycle function, eg: a wrapper calling pid_bank_on_processing(bank)
+        pid_rt_step_f hold;         // called on PID_RT_OVERRUN_HOLD, can be NULL
+        void *arg;                  // argument of step and hold
+    } pid_rt_config_t;
+
+    typedef struct _pid_rt_stats_t
+    {
+        uint64_t cycles;         // number of step() calls
+        uint64_t missed;         // number of missed deadlines
+        uint64_t held;           // number of hold() cycles
+        uint64_t max_latency_ns; // worst wake up latency
+        uint64_t max_exec_ns;    // worst step() execution time
+    } pid_rt_stats_t;
+
+    typedef struct _pid_rt_runner_t
+    {
+        pid_rt_config_t config;
+        pid_rt_stats_t stats;
+        uint32_t seq; // stats seqlock, odd while the runner thread writes
+        pthread_t thread;
+        bool realtime; // SCHED_FIFO and mlockall were granted, false with priority 0
+        int running;
+    } pid_rt_runner_t;
+
+    /**
+     * @brief fill a runner configuration with the default values
+     * 
+     * @param config 
+     * @param period_ns     cycle period
+     * @param step          cycle function
+     * @param arg           argument of the cycle function
+     */
+    void pid_rt_config_default(pid_rt_config_t *config, uint64_t period_ns, pid_rt_step_f step, void *arg);
+
+    /**
+     * @brief start the runner thread
+     * If the real time privileges are not available (SCHED_FIFO, mlockall),
+     * a warning is logged and the runner continues with the default scheduler,
+     * runner->realtime tells whether both were granted
+     * 
+     * @param runner 
+     * @param config 
+     * @return pid_result_t PID_ERROR if prefault_stack is above PID_RT_DEFAULT_PREFAULT_STACK
+     */
+    pid_result_t pid_rt_start(pid_rt_runner_t *runner, const pid_rt_config_t *config);
+
+    /**
+     * @brief stop the runner thread and wait for it
+     * 
+     * @param runner 
+     * @return pid_result_t 
+     */
+    pid_result_t pid_rt_stop(pid_rt_runner_t *runner);
+
+    /**
+     * @brief read the runner statistics
+     * The copy is consistent, it can be taken while the runner is running
+     * 
+     * @param runner 
+     * @param stats 
+     * @return pid_result_t 
+     */
+    pid_result_t pid_rt_get_stats(pid_rt_runner_t *runner, pid_rt_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __PID_RT_H__
@@ -0,0 +1,271 @@
+#include "pid-sdt.h"
+
+/**
+ * @brief initialize the compressor of one signal
+ * 
+ * @param sdt 
+ * @param dev           error bound, >= 0
+ * @param max_gap       maximum ticks between two archived points, 0 for no limit
+ * @return pid_result_t 
+ */
+pid_result_t pid_sdt_init(pid_sdt_t *sdt, float dev, uint32_t max_gap)
+{
+    PID_RETURN_IF_NULL(sdt);
+    if (!(dev >= 0))
+        return PID_ERROR;
+
+    memset(sdt, 0, sizeof(pid_sdt_t));
+    sdt->dev = dev;
+    sdt->max_gap = max_gap;
+    return PID_OK;
+}
+
+/**
+ * @brief open the doors from the archived point through (tick, value)
+ * 
+ * @param sdt 
+ * @param dt            ticks since the archived point, > 0
+ * @param value 
+ */
+static inline void pid_sdt_open(pid_sdt_t *sdt, uint32_t dt, float value)
+{
+    double d = (double)value - (double)sdt->v0;
+
+    sdt->s_min = (d - sdt->dev) / dt;
+    sdt->s_max = (d + sdt->dev) / dt;
+}
+
+/**
+ * @brief compress one sample
+ * 
+ * @param sdt 
+ * @param tick          sample time, increasing (wrapping uint32)
+ * @param value         sample value
+ * @param out           archived point, if any
+ * @return int          number of archived points (0 or 1)
+ */
+int pid_sdt_push(pid_sdt_t *sdt, uint32_t tick, float value, pid_sdt_point_t *out)
+{
+    uint32_t dt;
+    double d, inv, s, lo, hi;
+    int n = 0;
+
+    if (!sdt->started)
+    {
+        sdt->t0 = tick;
+        sdt->v0 = value;
+        sdt->started = 1;
+        sdt->pending = 0;
+        out->tick = tick;
+        out->value = value;
+        return 1;
+    }
+
+    dt = tick - sdt->t0;
+    if (dt == 0)
+        return 0;
+
+    if (!sdt->pending)
+    {
+        pid_sdt_open(sdt, dt, value);
+    }
+    else
+    {
+        d = (double)value - (double)sdt->v0;
+        inv = 1.0 / dt;
+        s = d * inv;
+        if ((s < sdt->s_min) || (s > sdt->s_max) || (sdt->max_gap && (dt > sdt->max_gap)))
+        {
+            // the line to this point would leave a dropped point outside
+            // the bound: archive the last point, restart the doors from it
+            out->tick = sdt->tl;
+            out->value = sdt->vl;
+            n = 1;
+            sdt->t0 = sdt->tl;
+            sdt->v0 = sdt->vl;
+            pid_sdt_open(sdt, tick - sdt->t0, value);
+        }
+        else
+        {
+            // close the doors
+            lo = (d - sdt->dev) * inv;
+            hi = (d + sdt->dev) * inv;
+            if (lo > sdt->s_min)
+                sdt->s_min = lo;
+            if (hi < sdt->s_max)
+                sdt->s_max = hi;
+        }
+    }
+
+    sdt->tl = tick;
+    sdt->vl = value;
+    sdt->pending = 1;
+    return n;
+}
+
+/**
+ * @brief archive the last received point, eg: at the end of a file
+ * 
+ * @param sdt 
+ * @param out           archived point, if any
+ * @return int          number of archived points (0 or 1)
+ */
+int pid_sdt_flush(pid_sdt_t *sdt, pid_sdt_point_t *out)
+{
+    if (!sdt->pending)
+        return 0;
+
+    out->tick = sdt->tl;
+    out->value = sdt->vl;
+    sdt->t0 = sdt->tl;
+    sdt->v0 = sdt->vl;
+    sdt->pending = 0;
+    return 1;
+}
+
+/**
+ * @brief rebuild the samples tick0 .. tick0 + count - 1 from archived points,
+ * by linear interpolation. The first / last value is held outside the points
+ * 
+ * @param point         archived points, increasing ticks
+ * @param n             number of points
+ * @param tick0         first tick
+ * @param out           array of count values
+ * @param count         number of values
+ * @return pid_result_t 
+ */
+pid_result_t pid_sdt_decompress(const pid_sdt_point_t *point, size_t n, uint32_t tick0, float *out, size_t count)
+{
+    size_t seg = 0;
+
+    PID_RETURN_IF_NULL(point);
+    PID_RETURN_IF_NULL(out);
+    if (!n)
+        return PID_ERROR;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t tick = tick0 + (uint32_t)i;
+
+        // ticks are compared relative to the first point, so that they can wrap
+        if ((int32_t)(tick - point[0].tick) <= 0)
+        {
+            out[i] = point[0].value;
+            continue;
+        }
+        while ((seg + 1 < n) && (tick - point[0].tick >= point[seg + 1].tick - point[0].tick))
+            seg++;
+
+        if (seg + 1 >= n)
+        {
+            out[i] = point[n - 1].value;
+        }
+        else
+        {
+            const pid_sdt_point_t *a = &point[seg], *b = &point[seg + 1];
+            double f = (double)(tick - a->tick) / (double)(b->tick - a->tick);
+            out[i] = (float)((double)a->value + ((double)b->value - (double)a->value) * f);
+        }
+    }
+    return PID_OK;
+}
+
+/**
+ * @brief initialize the compressors of a pid handler trace
+ * 
+ * @param trace 
+ * @param pv_dev        pv error bound
+ * @param sv_dev        sv error bound
+ * @param cv_dev        cv error bound
+ * @param max_gap       maximum ticks between two archived points, 0 for no limit
+ * @return pid_result_t 
+ */
+pid_result_t pid_sdt_trace_init(pid_sdt_trace_t *trace, float pv_dev, float sv_dev, float cv_dev, uint32_t max_gap)
+{
+    PID_RETURN_IF_NULL(trace);
+
+    if ((pid_sdt_init(&trace->signal[PID_SDT_PV], pv_dev, max_gap) != PID_OK) ||
+        (pid_sdt_init(&trace->signal[PID_SDT_SV], sv_dev, max_gap) != PID_OK) ||
+        (pid_sdt_init(&trace->signal[PID_SDT_CV], cv_dev, max_gap) != PID_OK))
+        return PID_ERROR;
+    return PID_OK;
+}
+
+/**
+ * @brief compress the pv, sv and cv of a pid handler, after pid_on_processing
+ * 
+ * @param trace 
+ * @param tick          sample time
+ * @param pid 
+ * @param sink          called for each archived point
+ * @param ctx           sink context
+ * @param channel       channel index given to the sink
+ * @return int          number of archived points
+ */
+int pid_sdt_trace_push(pid_sdt_trace_t *trace, uint32_t tick, const pid_handle_t *pid,
+                       pid_sdt_sink_f sink, void *ctx, uint32_t channel)
+{
+    const float value[PID_SDT_SIGNAL_MAX] = {pid->control.pv.value, pid->control.sv, pid->control.cv.buff[0]};
+    pid_sdt_point_t point;
+    int n = 0;
+
+    for (int s = 0; s < PID_SDT_SIGNAL_MAX; s++)
+    {
+        if (pid_sdt_push(&trace->signal[s], tick, value[s], &point))
+        {
+            n++;
+            if (sink)
+                sink(ctx, channel, (pid_sdt_signal_e)s, &point);
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief compress a whole bank, trace[i] follows bank->pid[i]
+ * 
+ * @param trace         array of bank->count traces
+ * @param bank 
+ * @param tick          sample time
+ * @param sink          called for each archived point
+ * @param ctx           sink context
+ * @return size_t       number of archived points
+ */
+size_t pid_sdt_bank_push(pid_sdt_trace_t *trace, const pid_bank_t *bank, uint32_t tick,
+                         pid_sdt_sink_f sink, void *ctx)
+{
+    size_t n = 0;
+
+    if (!trace || !bank)
+        return 0;
+
+    for (size_t i = 0; i < bank->count; i++)
+        n += (size_t)pid_sdt_trace_push(&trace[i], tick, &bank->pid[i], sink, ctx, (uint32_t)i);
+    return n;
+}
+
+/**
+ * @brief archive the pending points of a trace
+ * 
+ * @param trace 
+ * @param sink 
+ * @param ctx 
+ * @param channel 
+ * @return int          number of archived points
+ */
+int pid_sdt_trace_flush(pid_sdt_trace_t *trace, pid_sdt_sink_f sink, void *ctx, uint32_t channel)
+{
+    pid_sdt_point_t point;
+    int n = 0;
+
+    for (int s = 0; s < PID_SDT_SIGNAL_MAX; s++)
+    {
+        if (pid_sdt_flush(&trace->signal[s], &point))
+        {
+            n++;
+            if (sink)
+                sink(ctx, channel, (pid_sdt_signal_e)s, &point);
+        }
+    }
+    return n;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file pid-sdt.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief swinging door compression of the controller history
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * Each signal keeps the last archived point, the last received point and
+ * the range of slopes [s_min; s_max] (the two doors pivoting at the archived
+ * point +/- dev) of the lines which pass within dev of every point received
+ * since the archived one. A new point extends the segment while its slope
+ * from the archived point stays inside the doors, otherwise the last point
+ * is archived and the doors restart from it.
+ *
+ * The linear interpolation between two archived points is within dev of
+ * every dropped point (up to the float rounding of the values).
+ */
+#ifndef __PID_SDT_H__
+#define __PID_SDT_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pid-bank.h"
+
+    typedef enum _pid_sdt_signal_e
+    {
+        PID_SDT_PV = 0,
+        PID_SDT_SV,
+        PID_SDT_CV,
+        PID_SDT_SIGNAL_MAX,
+    } pid_sdt_signal_e;
+
+    typedef struct _pid_sdt_point_t
+    {
+        uint32_t tick;
+        float value;
+    } pid_sdt_point_t;
+
+    /**
+     * @brief compressor state of one signal
+     */
+    typedef struct _pid_sdt_t
+    {
+        double s_min;     // lower door, slope per tick from the archived point
+        double s_max;     // upper door
+        float dev;        // error bound, same unit as the signal
+        uint32_t max_gap; // maximum ticks between two archived points, 0 for no limit
+        uint32_t t0;      // archived point
+        float v0;
+        uint32_t tl; // last received point
+        float vl;
+        uint8_t started; // a point was archived
+        uint8_t pending; // the last received point is not archived
+    } pid_sdt_t;
+
+    /**
+     * @brief compressor of the pv, sv and cv of one pid handler
+     */
+    typedef struct _pid_sdt_trace_t
+    {
+        pid_sdt_t signal[PID_SDT_SIGNAL_MAX];
+    } pid_sdt_trace_t;
+
+    /**
+     * @brief archived point sink
+     * 
+     * @param ctx       user context
+     * @param channel   channel index given to pid_sdt_trace_push
+     * @param signal    pid_sdt_signal_e
+     * @param point     archived point
+     */
+    typedef void (*pid_sdt_sink_f)(void *ctx, uint32_t channel, pid_sdt_signal_e signal, const pid_sdt_point_t *point);
+
+    /**
+     * @brief initialize the compressor of one signal
+     * 
+     * @param sdt 
+     * @param dev           error bound, >= 0
+     * @param max_gap       maximum ticks between two archived points, 0 for no limit
+     * @return pid_result_t 
+     */
+    pid_result_t pid_sdt_init(pid_sdt_t *sdt, float dev, uint32_t max_gap);
+
+    /**
+     * @brief compress one sample
+     * 
+     * @param sdt 
+     * @param tick          sample time, increasing (wrapping uint32)
+     * @param value         sample value
+     * @param out           archived point, if any
+     * @return int          number of archived points (0 or 1)
+     */
+    int pid_sdt_push(pid_sdt_t *sdt, uint32_t tick, float value, pid_sdt_point_t *out);
+
+    /**
+     * @brief archive the last received point, eg: at the end of a file
+     * 
+     * @param sdt 
+     * @param out           archived point, if any
+     * @return int          number of archived points (0 or 1)
+     */
+    int pid_sdt_flush(pid_sdt_t *sdt, pid_sdt_point_t *out);
+
+    /**
+     * @brief rebuild the samples tick0 .. tick0 + count - 1 from archived points,
+     * by linear interpolation. The first / last value is held outside the points
+     * 
+     * @param point         archived points, increasing ticks
+     * @param n             number of points
+     * @param tick0         first tick
+     * @param out           array of count values
+     * @param count         number of values
+     * @return pid_result_t 
+     */
+    pid_result_t pid_sdt_decompress(const pid_sdt_point_t *point, size_t n, uint32_t tick0, float *out, size_t count);
+
+    /**
+     * @brief initialize the compressors of a pid handler trace
+     * 
+     * @param trace 
+     * @param pv_dev        pv error bound
+     * @param sv_dev        sv error bound
+     * @param cv_dev        cv error bound
+     * @param max_gap       maximum ticks between two archived points, 0 for no limit
+     * @return pid_result_t 
+     */
+    pid_result_t pid_sdt_trace_init(pid_sdt_trace_t *trace, float pv_dev, float sv_dev, float cv_dev, uint32_t max_gap);
+
+    /**
+     * @brief compress the pv, sv and cv of a pid handler, after pid_on_processing
+     * 
+     * @param trace 
+     * @param tick          sample time
+     * @param pid 
+     * @param sink          called for each archived point
+     * @param ctx           sink context
+     * @param channel       channel index given to the sink
+     * @return int          number of archived points
+     */
+    int pid_sdt_trace_push(pid_sdt_trace_t *trace, uint32_t tick, const pid_handle_t *pid,
+                           pid_sdt_sink_f sink, void *ctx, uint32_t channel);
+
+    /**
+     * @brief compress a whole bank, trace[i] follows bank->pid[i]
+     * 
+     * @param trace         array of bank->count traces
+     * @param bank 
+     * @param tick          sample time
+     * @param sink          called for each archived point
+     * @param ctx           sink context
+     * @return size_t       number of archived points
+     */
+    size_t pid_sdt_bank_push(pid_sdt_trace_t *trace, const pid_bank_t *bank, uint32_t tick,
+                             pid_sdt_sink_f sink, void *ctx);
+
+    /**
+     * @brief archive the pending points of a trace
+     * 
+     * @param trace 
+     * @param sink 
+     * @param ctx 
+     * @param channel 
+     * @return int          number of archived points
+     */
+    int pid_sdt_trace_flush(pid_sdt_trace_t *trace, pid_sdt_sink_f sink, void *ctx, uint32_t channel);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __PID_SDT_H__
@@ -0,0 +1,486 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "pid-server.h"
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+typedef struct _pid_server_client_t
+{
+    int fd;
+    uint8_t *buffer; // received bytes not served yet
+    size_t len;
+    size_t cap;
+    int32_t *result;
+    uint32_t result_cap;
+    struct _pid_server_client_t *prev;
+    struct _pid_server_client_t *next;
+} pid_server_client_t;
+
+/**
+ * @brief apply one command to a pid handler, an armed handler is re-armed
+ * 
+ * @param pid 
+ * @param cmd 
+ * @return pid_result_t 
+ */
+pid_result_t pid_server_apply_cmd(pid_handle_t *pid, const pid_cmd_t *cmd)
+{
+    pid_result_t err = PID_ERROR;
+    pid_control_property_t prop;
+    pid_para_t para;
+    bool armed;
+
+    PID_RETURN_IF_NULL(pid);
+    PID_RETURN_IF_NULL(cmd);
+
+    armed = (pid->armed.step != NULL);
+
+    switch (cmd->opcode)
+    {
+    case PID_CMD_SET_SV:
+        return pid_set_sv_value(pid, cmd->arg[0]);
+
+    case PID_CMD_SET_MODE:
+        if (cmd->arg[0] != (float)PID_MANUAL_MODE && cmd->arg[0] != (float)PID_AUTO_MODE)
+            return PID_ERROR;
+        return pid_set_operation_mode(pid, (pid_operation_mode_e)(int)cmd->arg[0]);
+
+    case PID_CMD_SET_PARAMETER:
+        memcpy(&para, &pid->parameter, sizeof(pid_para_t));
+        para.kp = cmd->arg[0];
+        para.ki = cmd->arg[1];
+        para.kd = cmd->arg[2];
+        err = pid_set_parameter(pid, &para);
+        if (err == PID_OK)
+            err = pid_extend_param_cal(pid);
+        break;
+
+    case PID_CMD_SET_SAMPLE_TIME:
+        err = pid_set_sample_time(pid, cmd->arg[0]);
+        if (err == PID_OK)
+            err = pid_extend_param_cal(pid);
+        break;
+
+    case PID_CMD_SET_CV_LIMIT_H:
+    case PID_CMD_SET_CV_LIMIT_L:
+    case PID_CMD_SET_GAIN:
+        prop.value = cmd->arg[0];
+        prop.enable = (cmd->arg[1] != 0);
+        if (cmd->opcode == PID_CMD_SET_CV_LIMIT_H)
+            err = pid_set_cv_limit_h(pid, &prop);
+        else if (cmd->opcode == PID_CMD_SET_CV_LIMIT_L)
+            err = pid_set_cv_limit_l(pid, &prop);
+        else
+            err = pid_set_gain(pid, &prop);
+        break;
+
+    default:
+        return PID_ERROR;
+    }
+
+    // the configuration setters disarm the handler
+    if ((err == PID_OK) && armed)
+        err = pid_arm(pid);
+    return err;
+}
+
+/**
+ * @brief apply a batch of commands to a bank, one result per command
+ * 
+ * @param bank 
+ * @param cmd           array of count commands
+ * @param count         number of commands
+ * @param result        array of count results
+ * @return pid_result_t PID_OK, or the last error of the batch
+ */
+pid_result_t pid_server_apply(pid_bank_t *bank, const pid_cmd_t *cmd, uint32_t count, int32_t *result)
+{
+    pid_result_t err = PID_OK;
+
+    PID_RETURN_IF_NULL(bank);
+    PID_RETURN_IF_NULL(cmd);
+    PID_RETURN_IF_NULL(result);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (cmd[i].index >= bank->count)
+            result[i] = PID_ERROR;
+        else
+            result[i] = pid_server_apply_cmd(&bank->pid[cmd[i].index], &cmd[i]);
+        if (result[i] != PID_OK)
+            err = (pid_result_t)result[i];
+    }
+    return err;
+}
+
+/**
+ * @brief hand a batch over to the control thread and wait for the tick
+ * If the control thread does not apply it within PID_SERVER_TICK_TIMEOUT_MS,
+ * the batch is withdrawn and every command fails with PID_ERROR
+ * 
+ * @param srv 
+ * @param cmd 
+ * @param count 
+ * @param result 
+ */
+static void pid_server_submit(pid_server_t *srv, const pid_cmd_t *cmd, uint32_t count, int32_t *result)
+{
+    struct timespec deadline;
+    int ret = 0;
+
+    if (!srv->tick_driven)
+    {
+        pid_server_apply(srv->bank, cmd, count, result);
+        srv->batches++;
+        srv->commands += count;
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += PID_SERVER_TICK_TIMEOUT_MS / 1000;
+    deadline.tv_nsec += (PID_SERVER_TICK_TIMEOUT_MS % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&srv->lock);
+    srv->pending_cmd = cmd;
+    srv->pending_result = result;
+    srv->pending_count = count;
+    __atomic_store_n(&srv->pending, 1, __ATOMIC_RELEASE);
+    while (__atomic_load_n(&srv->pending, __ATOMIC_ACQUIRE) && (ret != ETIMEDOUT))
+        ret = pthread_cond_timedwait(&srv->done, &srv->lock, &deadline);
+
+    // the control thread only applies a batch under the lock, it can not
+    // be half applied here
+    if (__atomic_load_n(&srv->pending, __ATOMIC_ACQUIRE))
+    {
+        __atomic_store_n(&srv->pending, 0, __ATOMIC_RELEASE);
+        for (uint32_t i = 0; i < count; i++)
+            result[i] = PID_ERROR;
+        srv->expired++;
+    }
+    pthread_mutex_unlock(&srv->lock);
+}
+
+/**
+ * @brief apply the pending batch, if any (control thread, at the tick boundary)
+ * 
+ * @param srv 
+ * @return pid_result_t 
+ */
+pid_result_t pid_server_on_tick(pid_server_t *srv)
+{
+    PID_RETURN_IF_NULL(srv);
+
+    // nothing to do for most of the ticks
+    if (!__atomic_load_n(&srv->pending, __ATOMIC_ACQUIRE))
+        return PID_OK;
+    if (pthread_mutex_trylock(&srv->lock) != 0)
+        return PID_OK;
+
+    if (srv->pending)
+    {
+        pid_server_apply(srv->bank, srv->pending_cmd, srv->pending_count, srv->pending_result);
+        srv->batches++;
+        srv->commands += srv->pending_count;
+        __atomic_store_n(&srv->pending, 0, __ATOMIC_RELEASE);
+        pthread_cond_signal(&srv->done);
+    }
+    pthread_mutex_unlock(&srv->lock);
+    return PID_OK;
+}
+
+/**
+ * @brief send a reply, the server thread waits at most
+ * PID_SERVER_WRITE_TIMEOUT_MS for a client whose socket buffer is full
+ * 
+ * @param fd 
+ * @param data 
+ * @param size 
+ * @return int          -1 if the client has to be dropped
+ */
+static int pid_server_write_all(int fd, const uint8_t *data, size_t size)
+{
+    struct pollfd pfd = {fd, POLLOUT, 0};
+    ssize_t n;
+    int ready;
+
+    while (size)
+    {
+        n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n > 0)
+        {
+            data += n;
+            size -= (size_t)n;
+        }
+        else if ((n < 0) && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            do
+            {
+                ready = poll(&pfd, 1, PID_SERVER_WRITE_TIMEOUT_MS);
+            } while ((ready < 0) && (errno == EINTR));
+            if (ready <= 0)
+                return -1;
+        }
+        else if ((n < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        else
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void pid_server_close_client(pid_server_t *srv, pid_server_client_t *client)
+{
+    epoll_ctl(srv->epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    if (client->prev)
+        client->prev->next = client->next;
+    else
+        srv->clients = client->next;
+    if (client->next)
+        client->next->prev = client->prev;
+    free(client->buffer);
+    free(client->result);
+    free(client);
+}
+
+/**
+ * @brief serve every complete batch of the client buffer
+ * 
+ * @param srv 
+ * @param client 
+ * @return int      -1 if the client has to be closed
+ */
+static int pid_server_serve(pid_server_t *srv, pid_server_client_t *client)
+{
+    pid_cmd_header_t header;
+    size_t offset = 0, size;
+
+    while (client->len - offset >= sizeof(pid_cmd_header_t))
+    {
+        memcpy(&header, client->buffer + offset, sizeof(header));
+        if ((header.magic != PID_CMD_MAGIC) || (header.count > PID_CMD_MAX_BATCH))
+        {
+            PID_LOG("invalid command batch header\n");
+            return -1;
+        }
+
+        size = sizeof(header) + (size_t)header.count * sizeof(pid_cmd_t);
+        if (client->len - offset < size)
+            break;
+
+        if (header.count > client->result_cap)
+        {
+            int32_t *result = (int32_t *)realloc(client->result, header.count * sizeof(int32_t));
+            if (!result)
+                return -1;
+            client->result = result;
+            client->result_cap = header.count;
+        }
+
+        // the commands are aligned in the buffer: the buffer comes from
+        // malloc and header / command sizes are multiples of 4
+        pid_server_submit(srv, (const pid_cmd_t *)(client->buffer + offset + sizeof(header)),
+                          header.count, client->result);
+
+        if (pid_server_write_all(client->fd, (const uint8_t *)&header, sizeof(header)) ||
+            pid_server_write_all(client->fd, (const uint8_t *)client->result, header.count * sizeof(int32_t)))
+            return -1;
+        offset += size;
+    }
+
+    if (offset)
+    {
+        memmove(client->buffer, client->buffer + offset, client->len - offset);
+        client->len -= offset;
+    }
+    return 0;
+}
+
+static int pid_server_read(pid_server_t *srv, pid_server_client_t *client)
+{
+    ssize_t n;
+
+    for (;;)
+    {
+        if (client->cap - client->len < 4096)
+        {
+            size_t cap = client->cap ? client->cap * 2 : 65536;
+            uint8_t *buffer;
+            if (cap > sizeof(pid_cmd_header_t) + (size_t)PID_CMD_MAX_BATCH * sizeof(pid_cmd_t) * 2)
+                return -1;
+            buffer = (uint8_t *)realloc(client->buffer, cap);
+            if (!buffer)
+                return -1;
+            client->buffer = buffer;
+            client->cap = cap;
+        }
+
+        n = recv(client->fd, client->buffer + client->len, client->cap - client->len, 0);
+        if (n > 0)
+        {
+            client->len += (size_t)n;
+            if (pid_server_serve(srv, client))
+                return -1;
+            continue;
+        }
+        if (n == 0)
+            return -1;
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+        return -1;
+    }
+}
+
+/**
+ * @brief create the server and listen on a unix domain socket
+ * 
+ * @param srv 
+ * @param path          socket path, an existing socket file is replaced
+ * @param bank          bank the commands apply to
+ * @param tick_driven   true: batches are applied by pid_server_on_tick from
+ *                      the control thread; false: applied by pid_server_poll
+ * @return pid_result_t 
+ */
+pid_result_t pid_server_create(pid_server_t *srv, const char *path, pid_bank_t *bank, bool tick_driven)
+{
+    struct sockaddr_un addr;
+    struct epoll_event ev;
+    pthread_condattr_t cond_attr;
+
+    PID_RETURN_IF_NULL(srv);
+    PID_RETURN_IF_NULL(path);
+    PID_RETURN_IF_NULL(bank);
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return PID_ERROR;
+
+    memset(srv, 0, sizeof(pid_server_t));
+    srv->bank = bank;
+    srv->tick_driven = tick_driven;
+    strncpy(srv->path, path, sizeof(srv->path) - 1);
+    pthread_mutex_init(&srv->lock, NULL);
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&srv->done, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+
+    srv->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    srv->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (srv->listen_fd < 0 || srv->epoll_fd < 0)
+    {
+        PID_LOG("can not create the server socket, errno %d\n", errno);
+        pid_server_destroy(srv);
+        return PID_ERROR;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    unlink(path);
+    if (bind(srv->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(srv->listen_fd, 64) != 0)
+    {
+        PID_LOG("can not listen on the server socket, errno %d\n", errno);
+        pid_server_destroy(srv);
+        return PID_ERROR;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL; // NULL is the listening socket
+    epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, srv->listen_fd, &ev);
+    return PID_OK;
+}
+
+/**
+ * @brief wait for client events and serve complete batches (server thread)
+ * 
+ * @param srv 
+ * @param timeout_ms    epoll timeout, -1 to wait forever
+ * @return pid_result_t 
+ */
+pid_result_t pid_server_poll(pid_server_t *srv, int timeout_ms)
+{
+    struct epoll_event events[PID_SERVER_MAX_EVENTS], ev;
+    pid_server_client_t *client;
+    int n, fd;
+
+    PID_RETURN_IF_NULL(srv);
+
+    n = epoll_wait(srv->epoll_fd, events, PID_SERVER_MAX_EVENTS, timeout_ms);
+    if (n < 0)
+        return (errno == EINTR) ? PID_OK : PID_ERROR;
+
+    for (int i = 0; i < n; i++)
+    {
+        client = (pid_server_client_t *)events[i].data.ptr;
+        if (!client)
+        {
+            while ((fd = accept4(srv->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+            {
+                client = (pid_server_client_t *)calloc(1, sizeof(pid_server_client_t));
+                if (!client)
+                {
+                    close(fd);
+                    continue;
+                }
+                client->fd = fd;
+                client->next = srv->clients;
+                if (srv->clients)
+                    srv->clients->prev = client;
+                srv->clients = client;
+
+                ev.events = EPOLLIN | EPOLLRDHUP;
+                ev.data.ptr = client;
+                epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+            }
+            continue;
+        }
+
+        if (pid_server_read(srv, client) || (events[i].events & (EPOLLERR | EPOLLHUP)))
+            pid_server_close_client(srv, client);
+    }
+    return PID_OK;
+}
+
+/**
+ * @brief close the socket and the clients
+ * 
+ * @param srv 
+ */
+void pid_server_destroy(pid_server_t *srv)
+{
+    if (!srv)
+        return;
+
+    while (srv->clients)
+        pid_server_close_client(srv, srv->clients);
+    if (srv->listen_fd >= 0)
+    {
+        close(srv->listen_fd);
+        unlink(srv->path);
+    }
+    if (srv->epoll_fd >= 0)
+        close(srv->epoll_fd);
+    srv->listen_fd = -1;
+    srv->epoll_fd = -1;
+    pthread_cond_destroy(&srv->done);
+    pthread_mutex_destroy(&srv->lock);
+}
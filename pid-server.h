@@ -0,0 +1,148 @@
+/**
+ * @file pid-server.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * Local command server: a client sends a batch of commands over a unix
+ * domain socket, the batch is applied to the bank between two ticks and
+ * the client receives one pid_result_t per command.
+ *
+ * request  : pid_cmd_header_t + count * pid_cmd_t
+ * response : pid_cmd_header_t + count * int32_t (pid_result_t)
+ *
+ * The messages use the host byte order, the socket is local only.
+ */
+#ifndef __PID_SERVER_H__
+#define __PID_SERVER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "pid-bank.h"
+
+#define PID_CMD_MAGIC (0x31424350U) // "PCB1"
+#define PID_CMD_MAX_BATCH (65536U)
+#define PID_SERVER_MAX_EVENTS (32U)
+#define PID_SERVER_PATH_SIZE (108U)
+#define PID_SERVER_WRITE_TIMEOUT_MS (100) // a client not reading its results is dropped
+#define PID_SERVER_TICK_TIMEOUT_MS (1000) // a batch not applied by the control thread fails
+
+    typedef enum _pid_cmd_opcode_e
+    {
+        PID_CMD_SET_SV = 0,      // arg[0]: sv
+        PID_CMD_SET_PARAMETER,   // arg[0..2]: kp, ki, kd, the coefficients are recomputed
+        PID_CMD_SET_CV_LIMIT_H,  // arg[0]: value, arg[1]: enable (0 / 1)
+        PID_CMD_SET_CV_LIMIT_L,  // arg[0]: value, arg[1]: enable (0 / 1)
+        PID_CMD_SET_GAIN,        // arg[0]: value, arg[1]: enable (0 / 1)
+        PID_CMD_SET_MODE,        // arg[0]: pid_operation_mode_e, other values are rejected
+        PID_CMD_SET_SAMPLE_TIME, // arg[0]: sample time, the coefficients are recomputed
+        PID_CMD_MAX,
+    } pid_cmd_opcode_e;
+
+    typedef struct _pid_cmd_header_t
+    {
+        uint32_t magic; // PID_CMD_MAGIC
+        uint32_t count; // number of commands / results following the header
+    } pid_cmd_header_t;
+
+    typedef struct _pid_cmd_t
+    {
+        uint32_t index;  // pid handler index in the bank
+        uint16_t opcode; // pid_cmd_opcode_e
+        uint16_t reserved;
+        float arg[3];
+    } pid_cmd_t;
+
+    struct _pid_server_client_t;
+
+    typedef struct _pid_server_t
+    {
+        int listen_fd;
+        int epoll_fd;
+        pid_bank_t *bank;
+        bool tick_driven; // batches are applied by pid_server_on_tick
+        struct _pid_server_client_t *clients;
+
+        // batch handed over to the control thread
+        pthread_mutex_t lock;
+        pthread_cond_t done;
+        const pid_cmd_t *pending_cmd;
+        int32_t *pending_result;
+        uint32_t pending_count;
+        int pending; // a batch is waiting for the tick boundary
+
+        uint64_t batches;  // number of applied batches
+        uint64_t commands; // number of applied commands
+        uint64_t expired;  // batches withdrawn after PID_SERVER_TICK_TIMEOUT_MS
+        char path[PID_SERVER_PATH_SIZE];
+    } pid_server_t;
+
+    /**
+     * @brief apply one command to a pid handler, an armed handler is re-armed
+     *
+     * @param pid
+     * @param cmd
+     * @return pid_result_t
+     */
+    pid_result_t pid_server_apply_cmd(pid_handle_t *pid, const pid_cmd_t *cmd);
+
+    /**
+     * @brief apply a batch of commands to a bank, one result per command
+     *
+     * @param bank
+     * @param cmd           array of count commands
+     * @param count         number of commands
+     * @param result        array of count results
+     * @return pid_result_t PID_OK, or the last error of the batch
+     */
+    pid_result_t pid_server_apply(pid_bank_t *bank, const pid_cmd_t *cmd, uint32_t count, int32_t *result);
+
+    /**
+     * @brief create the server and listen on a unix domain socket
+     *
+     * @param srv
+     * @param path          socket path, an existing socket file is replaced
+     * @param bank          bank the commands apply to
+     * @param tick_driven   true: batches are applied by pid_server_on_tick from
+     *                      the control thread; false: applied by pid_server_poll
+     * @return pid_result_t
+     */
+    pid_result_t pid_server_create(pid_server_t *srv, const char *path, pid_bank_t *bank, bool tick_driven);
+
+    /**
+     * @brief wait for client events and serve complete batches (server thread)
+     *
+     * @param srv
+     * @param timeout_ms    epoll timeout, -1 to wait forever
+     * @return pid_result_t
+     */
+    pid_result_t pid_server_poll(pid_server_t *srv, int timeout_ms);
+
+    /**
+     * @brief apply the pending batch, if any (control thread, at the tick boundary)
+     *
+     * @param srv
+     * @return pid_result_t
+     */
+    pid_result_t pid_server_on_tick(pid_server_t *srv);
+
+    /**
+     * @brief close the socket and the clients
+     *
+     * @param srv
+     */
+    void pid_server_destroy(pid_server_t *srv);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __PID_SERVER_H__
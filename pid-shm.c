@@ -0,0 +1,239 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "pid-shm.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+static size_t pid_shm_size(size_t count)
+{
+    return sizeof(pid_shm_header_t) + count * sizeof(pid_shm_record_t);
+}
+
+/**
+ * @brief create the shared memory segment of the publisher, eg: "/lw-pid"
+ * 
+ * @param shm 
+ * @param name          posix shared memory name, starting with '/'
+ * @param count         number of records
+ * @return pid_result_t 
+ */
+pid_result_t pid_shm_create(pid_shm_t *shm, const char *name, size_t count)
+{
+    void *base;
+
+    PID_RETURN_IF_NULL(shm);
+    PID_RETURN_IF_NULL(name);
+
+    memset(shm, 0, sizeof(pid_shm_t));
+    shm->fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (shm->fd < 0)
+    {
+        PID_LOG("shm_open failed, errno %d\n", errno);
+        return PID_ERROR;
+    }
+
+    shm->size = pid_shm_size(count);
+    if (ftruncate(shm->fd, (off_t)shm->size) != 0)
+    {
+        PID_LOG("ftruncate failed, errno %d\n", errno);
+        close(shm->fd);
+        shm_unlink(name);
+        return PID_ERR_MEM;
+    }
+
+    base = mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+    if (base == MAP_FAILED)
+    {
+        PID_LOG("mmap failed, errno %d\n", errno);
+        close(shm->fd);
+        shm_unlink(name);
+        return PID_ERR_MEM;
+    }
+
+    shm->header = (pid_shm_header_t *)base;
+    shm->record = (pid_shm_record_t *)(shm->header + 1);
+    shm->owner = true;
+    strncpy(shm->name, name, sizeof(shm->name) - 1);
+
+    memset(base, 0, shm->size);
+    shm->header->version = PID_SHM_VERSION;
+    shm->header->count = (uint32_t)count;
+    shm->header->record_size = sizeof(pid_shm_record_t);
+    // readers check the magic last
+    __atomic_store_n(&shm->header->magic, PID_SHM_MAGIC, __ATOMIC_RELEASE);
+    return PID_OK;
+}
+
+/**
+ * @brief open an existing segment read only, for a reader process
+ * 
+ * @param shm 
+ * @param name          posix shared memory name
+ * @return pid_result_t 
+ */
+pid_result_t pid_shm_open(pid_shm_t *shm, const char *name)
+{
+    struct stat st;
+    void *base;
+    pid_shm_header_t *header;
+
+    PID_RETURN_IF_NULL(shm);
+    PID_RETURN_IF_NULL(name);
+
+    memset(shm, 0, sizeof(pid_shm_t));
+    shm->fd = shm_open(name, O_RDONLY, 0);
+    if (shm->fd < 0)
+        return PID_ERROR;
+
+    if ((fstat(shm->fd, &st) != 0) || ((size_t)st.st_size < sizeof(pid_shm_header_t)))
+    {
+        close(shm->fd);
+        return PID_ERROR;
+    }
+
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, shm->fd, 0);
+    if (base == MAP_FAILED)
+    {
+        close(shm->fd);
+        return PID_ERR_MEM;
+    }
+
+    header = (pid_shm_header_t *)base;
+    if ((__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != PID_SHM_MAGIC) ||
+        (header->version != PID_SHM_VERSION) ||
+        (header->record_size != sizeof(pid_shm_record_t)) ||
+        (pid_shm_size(header->count) > (size_t)st.st_size))
+    {
+        PID_LOG("not a pid shared memory segment\n");
+        munmap(base, (size_t)st.st_size);
+        close(shm->fd);
+        return PID_ERROR;
+    }
+
+    shm->size = (size_t)st.st_size;
+    shm->header = header;
+    shm->record = (pid_shm_record_t *)(header + 1);
+    shm->owner = false;
+    strncpy(shm->name, name, sizeof(shm->name) - 1);
+    return PID_OK;
+}
+
+/**
+ * @brief unmap the segment, the publisher also unlinks it
+ * 
+ * @param shm 
+ */
+void pid_shm_close(pid_shm_t *shm)
+{
+    if (!shm || !shm->header)
+        return;
+
+    munmap(shm->header, shm->size);
+    close(shm->fd);
+    if (shm->owner)
+        shm_unlink(shm->name);
+    shm->header = NULL;
+    shm->record = NULL;
+}
+
+/**
+ * @brief publish the state of one pid handler (control thread)
+ * 
+ * @param shm 
+ * @param index         record index
+ * @param pid 
+ * @return pid_result_t 
+ */
+pid_result_t pid_shm_publish(pid_shm_t *shm, size_t index, const pid_handle_t *pid)
+{
+    pid_shm_record_t *rec;
+    uint32_t seq;
+
+    PID_RETURN_IF_NULL(shm);
+    PID_RETURN_IF_NULL(pid);
+    if (!shm->record || index >= shm->header->count)
+        return PID_ERROR;
+
+    rec = &shm->record[index];
+    seq = rec->seq;
+
+    // single writer: odd sequence, body, even sequence
+    __atomic_store_n(&rec->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    rec->tick++;
+    rec->sv = pid->control.sv;
+    rec->pv = pid->control.pv.value;
+    rec->cv = pid->control.cv.buff[0];
+    rec->error = pid->control.err[1]; // e(k), already shifted by the step
+    rec->result = pid->err;
+    rec->mode = (uint8_t)pid->control.operation_mode;
+    rec->phase = (uint8_t)pid->operation_phase;
+
+    __atomic_store_n(&rec->seq, seq + 2, __ATOMIC_RELEASE);
+    return PID_OK;
+}
+
+/**
+ * @brief publish the state of every pid handler of a bank (control thread)
+ * 
+ * @param shm 
+ * @param bank 
+ * @return pid_result_t 
+ */
+pid_result_t pid_shm_publish_bank(pid_shm_t *shm, const pid_bank_t *bank)
+{
+    PID_RETURN_IF_NULL(shm);
+    PID_RETURN_IF_NULL(bank);
+    if (!shm->record || bank->count > shm->header->count)
+        return PID_ERROR;
+
+    for (size_t i = 0; i < bank->count; i++)
+    {
+        pid_shm_publish(shm, i, &bank->pid[i]);
+    }
+    return PID_OK;
+}
+
+/**
+ * @brief read a consistent copy of one record, never blocks the publisher
+ * 
+ * @param shm 
+ * @param index         record index
+ * @param record        copy of the record
+ * @return pid_result_t PID_ERROR if no consistent copy was read after
+ *                      PID_SHM_READ_RETRY tries
+ */
+pid_result_t pid_shm_read(const pid_shm_t *shm, size_t index, pid_shm_record_t *record)
+{
+    const pid_shm_record_t *rec;
+    uint32_t seq0, seq1;
+
+    PID_RETURN_IF_NULL(shm);
+    PID_RETURN_IF_NULL(record);
+    if (!shm->record || index >= shm->header->count)
+        return PID_ERROR;
+
+    rec = &shm->record[index];
+    for (uint32_t retry = 0; retry < PID_SHM_READ_RETRY; retry++)
+    {
+        seq0 = __atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE);
+        if (seq0 & 1U)
+            continue;
+
+        memcpy(record, (const void *)rec, sizeof(pid_shm_record_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        seq1 = __atomic_load_n(&rec->seq, __ATOMIC_RELAXED);
+        if (seq0 == seq1)
+        {
+            record->seq = seq0;
+            return PID_OK;
+        }
+    }
+    return PID_ERROR;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file pid-shm.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief 
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+#ifndef __PID_SHM_H__
+#define __PID_SHM_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pid-bank.h"
+
+#define PID_SHM_MAGIC (0x50534D31U) // "PSM1"
+#define PID_SHM_VERSION (1U)
+#define PID_SHM_NAME_SIZE (64U)
+#define PID_SHM_READ_RETRY (1000U)
+
+    /**
+     * @brief published state of one pid handler
+     * seq is odd while the control thread writes the record
+     */
+    typedef struct _pid_shm_record_t
+    {
+        uint32_t seq;   // sequence lock
+        uint32_t tick;  // number of publications of this record
+        float sv;       // set value
+        float pv;       // process value
+        float cv;       // control value, cv.buff[0]
+        float error;    // e(k) = sv - pv
+        int32_t result; // pid_result_t of the handler
+        uint8_t mode;   // pid_operation_mode_e
+        uint8_t phase;  // pid_operation_phase
+        uint16_t reserved;
+    } pid_shm_record_t;
+
+    typedef struct _pid_shm_header_t
+    {
+        uint32_t magic;       // PID_SHM_MAGIC
+        uint32_t version;     // PID_SHM_VERSION
+        uint32_t count;       // number of records
+        uint32_t record_size; // sizeof(pid_shm_record_t)
+    } pid_shm_header_t;
+
+    typedef struct _pid_shm_t
+    {
+        int fd;
+        size_t size;
+        pid_shm_header_t *header;
+        pid_shm_record_t *record;
+        bool owner; // created by pid_shm_create, the segment is unlinked on close
+        char name[PID_SHM_NAME_SIZE];
+    } pid_shm_t;
+
+    /**
+     * @brief create the shared memory segment of the publisher, eg: "/lw-pid"
+     * 
+     * @param shm 
+     * @param name          posix shared memory name, starting with '/'
+     * @param count         number of records
+     * @return pid_result_t 
+     */
+    pid_result_t pid_shm_create(pid_shm_t *shm, const char *name, size_t count);
+
+    /**
+     * @brief open an existing segment read only, for a reader process
+     * 
+     * @param shm 
+     * @param name          posix shared memory name
+     * @return pid_result_t 
+     */
+    pid_result_t pid_shm_open(pid_shm_t *shm, const char *name);
+
+    /**
+     * @brief unmap the segment, the publisher also unlinks it
+     * 
+     * @param shm 
+     */
+    void pid_shm_close(pid_shm_t *shm);
+
+    /**
+     * @brief publish the state of one pid handler (control thread)
+     * 
+     * @param shm 
+     * @param index         record index
+     * @param pid 
+     * @return pid_result_t 
+     */
+    pid_result_t pid_shm_publish(pid_shm_t *shm, size_t index, const pid_handle_t *pid);
+
+    /**
+     * @brief publish the state of every pid handler of a bank (control thread)
+     * 
+     * @param shm 
+     * @param bank 
+     * @return pid_result_t 
+     */
+    pid_result_t pid_shm_publish_bank(pid_shm_t *shm, const pid_bank_t *bank);
+
+    /**
+     * @brief read a consistent copy of one record, never blocks the publisher
+     * 
+     * @param shm 
+     * @param index         record index
+     * @param record        copy of the record
+     * @return pid_result_t PID_ERROR if no consistent copy was read after
+     *                      PID_SHM_READ_RETRY tries
+     */
+    pid_result_t pid_shm_read(const pid_shm_t *shm, size_t index, pid_shm_record_t *record);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __PID_SHM_H__
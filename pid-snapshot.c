@@ -0,0 +1,235 @@
+#include "pid-snapshot.h"
+#include <stdlib.h>
+
+/**
+ * @brief take a snapshot of the dynamic state of a pid handler
+ * 
+ * @param pid 
+ * @param snap 
+ * @return pid_result_t 
+ */
+pid_result_t pid_snapshot_take(const pid_handle_t *pid, pid_snapshot_t *snap)
+{
+    PID_RETURN_IF_NULL(pid);
+    PID_RETURN_IF_NULL(snap);
+
+    snap->magic = PID_SNAPSHOT_MAGIC;
+    memcpy(snap->err, pid->control.err, sizeof(snap->err));
+    memcpy(snap->cv, pid->control.cv.buff, sizeof(snap->cv));
+    snap->pv = pid->control.pv.value;
+    snap->operation_mode = pid->control.operation_mode;
+    snap->output_fraction = pid->control.output.fraction;
+    snap->output_code = pid->control.output.code;
+    snap->output_valid = pid->control.output.valid ? 1 : 0;
+    snap->event_last_pv = pid->control.event.last_pv;
+    return PID_OK;
+}
+
+/**
+ * @brief restore the dynamic state of a pid handler
+ * The cv history and the output stage are restored as they were, so the next
+ * output continues from the last output before the restart (bumpless) and
+ * stays within the rate and slew limits
+ * 
+ * @param pid 
+ * @param snap 
+ * @return pid_result_t PID_ERR_SNAPSHOT if snap is not a valid snapshot
+ */
+pid_result_t pid_snapshot_restore(pid_handle_t *pid, const pid_snapshot_t *snap)
+{
+    PID_RETURN_IF_NULL(pid);
+    PID_RETURN_IF_NULL(snap);
+
+    if (snap->magic != PID_SNAPSHOT_MAGIC)
+    {
+        PID_LOG("invalid snapshot magic 0x%08x\n", (unsigned)snap->magic);
+        pid->err = PID_ERR_SNAPSHOT;
+        return PID_ERR_SNAPSHOT;
+    }
+
+    memcpy(pid->control.err, snap->err, sizeof(snap->err));
+    memcpy(pid->control.cv.buff, snap->cv, sizeof(snap->cv));
+    pid->control.pv.value = snap->pv;
+    pid->control.operation_mode = snap->operation_mode;
+    pid->control.output.fraction = snap->output_fraction;
+    pid->control.output.code = snap->output_code;
+    pid->control.output.valid = (snap->output_valid != 0);
+    pid->control.event.last_pv = snap->event_last_pv;
+
+    pid->err = PID_OK;
+    return PID_OK;
+}
+
+/**
+ * @brief save a snapshot to eeprom
+ * 
+ * @param base_addr 
+ * @param snap 
+ */
+void pid_snapshot_save(uint32_t base_addr, pid_snapshot_t *snap)
+{
+    eeprom_write_data(base_addr, (uint8_t *)snap, sizeof(pid_snapshot_t));
+}
+
+/**
+ * @brief read a snapshot from eeprom
+ * 
+ * @param base_addr 
+ * @param snap 
+ */
+void pid_snapshot_read(uint32_t base_addr, pid_snapshot_t *snap)
+{
+    eeprom_read_data(base_addr, (uint8_t *)snap, sizeof(pid_snapshot_t));
+}
+
+/**
+ * @brief allocate the state array of a bank snapshot
+ * 
+ * @param snap 
+ * @param count         number of pid handlers of the bank
+ * @return pid_result_t 
+ */
+pid_result_t pid_bank_snapshot_create(pid_bank_snapshot_t *snap, size_t count)
+{
+    PID_RETURN_IF_NULL(snap);
+
+    memset(snap, 0, sizeof(pid_bank_snapshot_t));
+    snap->state = (pid_snapshot_t *)calloc(count, sizeof(pid_snapshot_t));
+    if (!snap->state)
+    {
+        PID_LOG("can not allocate %u snapshots\n", (unsigned)count);
+        return PID_ERR_MEM;
+    }
+    snap->count = count;
+    return PID_OK;
+}
+
+/**
+ * @brief release the state array of a bank snapshot
+ * 
+ * @param snap 
+ */
+void pid_bank_snapshot_destroy(pid_bank_snapshot_t *snap)
+{
+    if (snap)
+    {
+        free(snap->state);
+        snap->state = NULL;
+        snap->count = 0;
+    }
+}
+
+/**
+ * @brief ask the control thread for a new snapshot (reader side)
+ * 
+ * @param snap 
+ * @return pid_result_t PID_ERROR if a request is still pending
+ */
+pid_result_t pid_bank_snapshot_request(pid_bank_snapshot_t *snap)
+{
+    PID_RETURN_IF_NULL(snap);
+
+    if (__atomic_load_n(&snap->request, __ATOMIC_ACQUIRE))
+        return PID_ERROR;
+
+    __atomic_store_n(&snap->ready, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&snap->status, PID_OK, __ATOMIC_RELAXED);
+    __atomic_store_n(&snap->request, 1, __ATOMIC_RELEASE);
+    return PID_OK;
+}
+
+/**
+ * @brief check if the requested snapshot is complete (reader side)
+ * 
+ * @param snap 
+ * @return true         snap->state can be read
+ */
+bool pid_bank_snapshot_ready(pid_bank_snapshot_t *snap)
+{
+    if (!snap)
+        return false;
+    return __atomic_load_n(&snap->ready, __ATOMIC_ACQUIRE) != 0;
+}
+
+/**
+ * @brief result of the last request (reader side)
+ * 
+ * @param snap 
+ * @return pid_result_t PID_ERROR while the request is pending,
+ * PID_ERR_SNAPSHOT if the snapshot does not match the bank
+ */
+pid_result_t pid_bank_snapshot_status(pid_bank_snapshot_t *snap)
+{
+    PID_RETURN_IF_NULL(snap);
+
+    if (__atomic_load_n(&snap->request, __ATOMIC_ACQUIRE))
+        return PID_ERROR;
+    return (pid_result_t)__atomic_load_n(&snap->status, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief copy the bank state if a snapshot is requested (control thread side)
+ * call this function at the tick boundary, after pid_bank_on_processing
+ * 
+ * @param bank 
+ * @param snap 
+ * @return pid_result_t 
+ */
+pid_result_t pid_bank_snapshot_on_tick(const pid_bank_t *bank, pid_bank_snapshot_t *snap)
+{
+    PID_RETURN_IF_NULL(bank);
+    PID_RETURN_IF_NULL(snap);
+
+    // nothing to do for most of the ticks
+    if (!__atomic_load_n(&snap->request, __ATOMIC_ACQUIRE))
+        return PID_OK;
+
+    if (snap->count != bank->count)
+    {
+        PID_LOGW("snapshot of %u pid requested on a bank of %u\n",
+                 (unsigned)snap->count, (unsigned)bank->count);
+        __atomic_store_n(&snap->status, PID_ERR_SNAPSHOT, __ATOMIC_RELAXED);
+        __atomic_store_n(&snap->request, 0, __ATOMIC_RELEASE);
+        return PID_ERR_SNAPSHOT;
+    }
+
+    for (size_t i = 0; i < bank->count; i++)
+    {
+        pid_snapshot_take(&bank->pid[i], &snap->state[i]);
+    }
+    snap->seq++;
+
+    __atomic_store_n(&snap->ready, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&snap->request, 0, __ATOMIC_RELEASE);
+    return PID_OK;
+}
+
+/**
+ * @brief restore the dynamic state of a whole bank
+ * 
+ * @param bank 
+ * @param snap 
+ * @return pid_result_t PID_ERR_SNAPSHOT if the snapshot does not match the bank
+ */
+pid_result_t pid_bank_snapshot_restore(pid_bank_t *bank, const pid_bank_snapshot_t *snap)
+{
+    pid_result_t err = PID_OK, ret = PID_OK;
+
+    PID_RETURN_IF_NULL(bank);
+    PID_RETURN_IF_NULL(snap);
+
+    if (snap->count != bank->count)
+    {
+        PID_LOG("snapshot of %u pid can not be restored to a bank of %u\n",
+                (unsigned)snap->count, (unsigned)bank->count);
+        return PID_ERR_SNAPSHOT;
+    }
+
+    for (size_t i = 0; i < bank->count; i++)
+    {
+        ret = pid_snapshot_restore(&bank->pid[i], &snap->state[i]);
+        if (ret != PID_OK)
+            err = ret;
+    }
+    return err;
+}
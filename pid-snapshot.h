@@ -0,0 +1,163 @@
+/**
+ * @file pid-snapshot.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief 
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+#ifndef __PID_SNAPSHOT_H__
+#define __PID_SNAPSHOT_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include "pid-bank.h"
+
+#define PID_SNAPSHOT_MAGIC (0x50534E33U) // "PSN3", event mode pv added
+
+    /**
+     * @brief dynamic state of a pid controller, used for warm restart
+     * The configuration (parameter, range, io...) is not part of the snapshot,
+     * it is restored by pid_read_data / the application as usual
+     */
+    typedef struct _pid_snapshot_t
+    {
+        uint32_t magic;                      // PID_SNAPSHOT_MAGIC when valid
+        float err[PID_ERR_BUFF_SIZE];        // error history
+        float cv[PID_ERR_BUFF_SIZE];         // control value history
+        float pv;                            // last process value
+        pid_operation_mode_e operation_mode; // manual / auto mode
+        float output_fraction;               // output stage, last output after rate limitation
+        uint32_t output_code;                // output stage, last dac code
+        uint8_t output_valid;                // output stage, the rate and slew limits apply
+        float event_last_pv;                 // event mode, pv of the last computed sample
+    } pid_snapshot_t;
+
+    /**
+     * @brief snapshot of a whole bank, handed over from the control thread at
+     * a tick boundary
+     * 
+     * The reader calls pid_bank_snapshot_request(), the control thread calls
+     * pid_bank_snapshot_on_tick() after each pid_bank_on_processing() and
+     * copies the bank state only when a request is pending. The reader owns
+     * the state array again once pid_bank_snapshot_ready() returns true.
+     * A request the control thread can not serve is cleared without setting
+     * ready, pid_bank_snapshot_status() then returns the reason.
+     */
+    typedef struct _pid_bank_snapshot_t
+    {
+        pid_snapshot_t *state; // array of count snapshots
+        size_t count;          // number of snapshots
+        uint32_t seq;          // number of completed snapshots
+        uint32_t request;      // set by the reader, cleared by the control thread
+        uint32_t ready;        // set by the control thread when state is complete
+        int32_t status;        // pid_result_t of the last served request
+    } pid_bank_snapshot_t;
+
+    /**
+     * @brief take a snapshot of the dynamic state of a pid handler
+     * 
+     * @param pid 
+     * @param snap 
+     * @return pid_result_t 
+     */
+    pid_result_t pid_snapshot_take(const pid_handle_t *pid, pid_snapshot_t *snap);
+
+    /**
+     * @brief restore the dynamic state of a pid handler
+     * The cv history and the output stage are restored as they were, so the next
+     * output continues from the last output before the restart (bumpless) and
+     * stays within the rate and slew limits
+     * 
+     * @param pid 
+     * @param snap 
+     * @return pid_result_t PID_ERR_SNAPSHOT if snap is not a valid snapshot
+     */
+    pid_result_t pid_snapshot_restore(pid_handle_t *pid, const pid_snapshot_t *snap);
+
+    /**
+     * @brief save a snapshot to eeprom
+     * 
+     * @param base_addr 
+     * @param snap 
+     */
+    void pid_snapshot_save(uint32_t base_addr, pid_snapshot_t *snap);
+
+    /**
+     * @brief read a snapshot from eeprom
+     * 
+     * @param base_addr 
+     * @param snap 
+     */
+    void pid_snapshot_read(uint32_t base_addr, pid_snapshot_t *snap);
+
+    /**
+     * @brief allocate the state array of a bank snapshot
+     * 
+     * @param snap 
+     * @param count         number of pid handlers of the bank
+     * @return pid_result_t 
+     */
+    pid_result_t pid_bank_snapshot_create(pid_bank_snapshot_t *snap, size_t count);
+
+    /**
+     * @brief release the state array of a bank snapshot
+     * 
+     * @param snap 
+     */
+    void pid_bank_snapshot_destroy(pid_bank_snapshot_t *snap);
+
+    /**
+     * @brief ask the control thread for a new snapshot (reader side)
+     * 
+     * @param snap 
+     * @return pid_result_t PID_ERROR if a request is still pending
+     */
+    pid_result_t pid_bank_snapshot_request(pid_bank_snapshot_t *snap);
+
+    /**
+     * @brief check if the requested snapshot is complete (reader side)
+     * 
+     * @param snap 
+     * @return true         snap->state can be read
+     */
+    bool pid_bank_snapshot_ready(pid_bank_snapshot_t *snap);
+
+    /**
+     * @brief result of the last request (reader side)
+     * 
+     * @param snap 
+     * @return pid_result_t PID_ERROR while the request is pending,
+     * PID_ERR_SNAPSHOT if the snapshot does not match the bank
+     */
+    pid_result_t pid_bank_snapshot_status(pid_bank_snapshot_t *snap);
+
+    /**
+     * @brief copy the bank state if a snapshot is requested (control thread side)
+     * call this function at the tick boundary, after pid_bank_on_processing
+     * 
+     * @param bank 
+     * @param snap 
+     * @return pid_result_t 
+     */
+    pid_result_t pid_bank_snapshot_on_tick(const pid_bank_t *bank, pid_bank_snapshot_t *snap);
+
+    /**
+     * @brief restore the dynamic state of a whole bank
+     * 
+     * @param bank 
+     * @param snap 
+     * @return pid_result_t PID_ERR_SNAPSHOT if the snapshot does not match the bank
+     */
+    pid_result_t pid_bank_snapshot_restore(pid_bank_t *bank, const pid_bank_snapshot_t *snap);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __PID_SNAPSHOT_H__
@@ -0,0 +1,402 @@
+#include "pid-spectrum.h"
+#include <stdlib.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI (3.14159265358979323846)
+#endif
+
+/**
+ * @brief fill a configuration with the default values
+ * window 256, no decimation, periods 4..128 ticks
+ * 
+ * @param config 
+ */
+void pid_spectrum_config_default(pid_spectrum_config_t *config)
+{
+    if (!config)
+        return;
+
+    config->window = 256;
+    config->decimation = 1;
+    config->min_period = 4.0f;
+    config->max_period = 128.0f;
+    config->amplitude = 1.0f;
+    config->ratio = 0.5f;
+}
+
+/**
+ * @brief allocate the rings and the tables of count loops
+ * 
+ * @param sp 
+ * @param config 
+ * @param count         number of loops
+ * @return pid_result_t 
+ */
+pid_result_t pid_spectrum_create(pid_spectrum_t *sp, const pid_spectrum_config_t *config, size_t count)
+{
+    pid_spectrum_config_t *c;
+    double span, k_first, k_last, sum = 0;
+    uint32_t w;
+
+    PID_RETURN_IF_NULL(sp);
+    PID_RETURN_IF_NULL(config);
+
+    memset(sp, 0, sizeof(pid_spectrum_t));
+    memcpy(&sp->config, config, sizeof(pid_spectrum_config_t));
+    c = &sp->config;
+    w = c->window;
+    if (!count || (w < 8) || (w > PID_SPECTRUM_MAX_WINDOW) || !c->decimation ||
+        !(c->min_period > 0) || !(c->max_period >= c->min_period) || !(c->ratio >= 0))
+        return PID_ERROR;
+
+    // bin k has a period of window * decimation / k ticks, DC and nyquist are excluded
+    span = (double)w * c->decimation;
+    k_first = ceil(span / c->max_period);
+    k_last = floor(span / c->min_period);
+    if (k_first < 1)
+        k_first = 1;
+    if (k_last > (double)(w / 2 - 1))
+        k_last = (double)(w / 2 - 1);
+    if (k_last < k_first)
+    {
+        PID_LOG("no bin between the periods %f and %f\n", c->min_period, c->max_period);
+        return PID_ERROR;
+    }
+    sp->k_first = (uint32_t)k_first;
+    sp->bins = (uint32_t)(k_last - k_first) + 1;
+    sp->count = count;
+
+    sp->err = (float *)calloc(count * w, sizeof(float));
+    sp->cv = (float *)calloc(count * w, sizeof(float));
+    if (c->decimation > 1)
+    {
+        sp->err_acc = (float *)calloc(count, sizeof(float));
+        sp->cv_acc = (float *)calloc(count, sizeof(float));
+    }
+    sp->hann = (float *)malloc(w * sizeof(float));
+    sp->coeff = (float *)malloc(sp->bins * sizeof(float));
+    sp->result = (pid_spectrum_result_t *)calloc(count, sizeof(pid_spectrum_result_t));
+    sp->seq = (uint32_t *)calloc(count, sizeof(uint32_t));
+    if (!sp->err || !sp->cv || ((c->decimation > 1) && (!sp->err_acc || !sp->cv_acc)) ||
+        !sp->hann || !sp->coeff || !sp->result || !sp->seq)
+    {
+        PID_LOG("can not allocate the spectrum of %u loops\n", (unsigned)count);
+        pid_spectrum_destroy(sp);
+        return PID_ERR_MEM;
+    }
+
+    for (uint32_t i = 0; i < w; i++)
+    {
+        sp->hann[i] = (float)(0.5 - 0.5 * cos(2.0 * M_PI * i / w));
+        sum += sp->hann[i];
+    }
+    // a sine of amplitude A gives |X(k)| = A.sum(hann) / 2 at its bin
+    sp->gain = (float)(2.0 / sum);
+    for (uint32_t b = 0; b < sp->bins; b++)
+        sp->coeff[b] = (float)(2.0 * cos(2.0 * M_PI * (sp->k_first + b) / w));
+    return PID_OK;
+}
+
+/**
+ * @brief push e(k) and u(k) of count pid handlers, after the tick (control thread)
+ * 
+ * @param sp 
+ * @param pid           array of count handlers, eg: bank->pid
+ * @param count         must be the count of the context
+ * @return pid_result_t 
+ */
+pid_result_t pid_spectrum_push_bank(pid_spectrum_t *sp, const pid_handle_t *pid, size_t count)
+{
+    uint32_t w, pos;
+    float scale;
+
+    PID_RETURN_IF_NULL(sp);
+    PID_RETURN_IF_NULL(pid);
+    if (count != sp->count)
+        return PID_ERROR;
+
+    w = sp->config.window;
+    pos = sp->pos;
+
+    if (sp->config.decimation > 1)
+    {
+        // boxcar average of the block: it only attenuates the oscillations
+        // faster than the analysed band (sidelobes about -13 dB), it does not
+        // remove their aliases
+        for (size_t i = 0; i < count; i++)
+        {
+            sp->err_acc[i] += pid[i].control.err[1];
+            sp->cv_acc[i] += pid[i].control.cv.buff[0];
+        }
+        if (++sp->phase < sp->config.decimation)
+            return PID_OK;
+
+        sp->phase = 0;
+        scale = 1.0f / (float)sp->config.decimation;
+        for (size_t i = 0; i < count; i++)
+        {
+            float e = sp->err_acc[i] * scale;
+            float u = sp->cv_acc[i] * scale;
+
+            __atomic_store(&sp->err[(size_t)pos * count + i], &e, __ATOMIC_RELAXED);
+            __atomic_store(&sp->cv[(size_t)pos * count + i], &u, __ATOMIC_RELAXED);
+            sp->err_acc[i] = 0;
+            sp->cv_acc[i] = 0;
+        }
+    }
+    else
+    {
+        // the history is shifted after the step: err[1] is e(k)
+        for (size_t i = 0; i < count; i++)
+        {
+            __atomic_store(&sp->err[(size_t)pos * count + i], &pid[i].control.err[1], __ATOMIC_RELAXED);
+            __atomic_store(&sp->cv[(size_t)pos * count + i], &pid[i].control.cv.buff[0], __ATOMIC_RELAXED);
+        }
+    }
+
+    if (sp->filled < w)
+        __atomic_store_n(&sp->filled, sp->filled + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&sp->pos, (pos + 1 == w) ? 0 : pos + 1, __ATOMIC_RELEASE);
+    return PID_OK;
+}
+
+/**
+ * @brief copy a ring oldest first, remove the mean and apply the window
+ * samples pushed during the copy may replace the oldest ones, the window
+ * is then shifted by a few samples, which does not matter to the detection
+ * 
+ * @param sp 
+ * @param ring          first sample of the loop, the samples are count floats apart
+ * @param pos           oldest sample
+ * @param x             window output
+ */
+static void pid_spectrum_window(const pid_spectrum_t *sp, const float *ring, uint32_t pos, float *x)
+{
+    uint32_t w = sp->config.window;
+    float mean = 0;
+
+    for (uint32_t i = 0; i < w; i++)
+    {
+        __atomic_load(&ring[(size_t)pos * sp->count], &x[i], __ATOMIC_RELAXED);
+        mean += x[i];
+        if (++pos == w)
+            pos = 0;
+    }
+    mean /= (float)w;
+    for (uint32_t i = 0; i < w; i++)
+        x[i] = (x[i] - mean) * sp->hann[i];
+}
+
+/**
+ * @brief power of every bin, the bins are updated together so that the
+ * inner loop is vectorized
+ * 
+ * @param sp 
+ * @param x             windowed samples
+ * @param s1            scratch of bins floats
+ * @param s2            scratch of bins floats
+ * @param power         bins outputs, |X(k)|^2
+ */
+static void pid_spectrum_goertzel(const pid_spectrum_t *sp, const float *x, float *s1, float *s2, float *power)
+{
+    uint32_t bins = sp->bins;
+    const float *coeff = sp->coeff;
+
+    for (uint32_t b = 0; b < bins; b++)
+    {
+        s1[b] = 0;
+        s2[b] = 0;
+    }
+    for (uint32_t i = 0; i < sp->config.window; i++)
+    {
+        float v = x[i];
+        for (uint32_t b = 0; b < bins; b++)
+        {
+            float s0 = v + coeff[b] * s1[b] - s2[b];
+            s2[b] = s1[b];
+            s1[b] = s0;
+        }
+    }
+    for (uint32_t b = 0; b < bins; b++)
+    {
+        float p = s1[b] * s1[b] + s2[b] * s2[b] - coeff[b] * s1[b] * s2[b];
+        power[b] = p > 0 ? p : 0;
+    }
+}
+
+/**
+ * @brief relative response of the Hann window to a sine d bins away from the
+ * bin centre, sinc(d) / (1 - d^2): 1 at d = 0, 0.85 (-1.4 dB) at d = 0.5
+ * 
+ * @param d             offset of the interpolated peak, in bins
+ * @return float 
+ */
+static float pid_spectrum_scallop(float d)
+{
+    float x;
+
+    d = fabsf(d);
+    if (d > 0.5f)
+        d = 0.5f;
+    if (d < 1e-4f)
+        return 1.0f;
+    x = (float)M_PI * d;
+    return sinf(x) / x / (1.0f - d * d);
+}
+
+/**
+ * @brief analyse the windows of the loops [first, first + n) (analysis thread)
+ * 
+ * @param sp 
+ * @param first 
+ * @param n 
+ * @return size_t       number of flagged loops in the range, 0 until the window is full
+ */
+size_t pid_spectrum_analyze(pid_spectrum_t *sp, size_t first, size_t n)
+{
+    float x[PID_SPECTRUM_MAX_WINDOW];
+    float s1[PID_SPECTRUM_MAX_WINDOW / 2], s2[PID_SPECTRUM_MAX_WINDOW / 2];
+    float pe[PID_SPECTRUM_MAX_WINDOW / 2], pu[PID_SPECTRUM_MAX_WINDOW / 2];
+    size_t flagged = 0;
+    uint32_t w, bins;
+
+    if (!sp || !sp->result || (first >= sp->count))
+        return 0;
+    if (__atomic_load_n(&sp->filled, __ATOMIC_ACQUIRE) < sp->config.window)
+        return 0;
+    if (n > sp->count - first)
+        n = sp->count - first;
+
+    w = sp->config.window;
+    bins = sp->bins;
+    for (size_t i = first; i < first + n; i++)
+    {
+        pid_spectrum_result_t res;
+        uint32_t pos = __atomic_load_n(&sp->pos, __ATOMIC_ACQUIRE);
+        uint32_t peak = 0;
+        double total = 0, lobe;
+        float k = 0, delta = 0, scallop;
+
+        pid_spectrum_window(sp, &sp->err[i], pos, x);
+        pid_spectrum_goertzel(sp, x, s1, s2, pe);
+        pid_spectrum_window(sp, &sp->cv[i], pos, x);
+        pid_spectrum_goertzel(sp, x, s1, s2, pu);
+
+        for (uint32_t b = 0; b < bins; b++)
+        {
+            total += pe[b];
+            if (pe[b] > pe[peak])
+                peak = b;
+        }
+
+        lobe = pe[peak];
+        k = (float)(sp->k_first + peak);
+        if ((peak > 0) && (peak + 1 < bins))
+        {
+            // parabolic interpolation of the magnitude between the neighbours
+            float m0 = sqrtf(pe[peak - 1]), m1 = sqrtf(pe[peak]), m2 = sqrtf(pe[peak + 1]);
+            float den = m0 - 2.0f * m1 + m2;
+
+            if (den < 0)
+                delta = 0.5f * (m0 - m2) / den;
+            k += delta;
+            lobe += pe[peak - 1] + pe[peak + 1];
+        }
+        else if (bins > 1)
+        {
+            lobe += (peak > 0) ? pe[peak - 1] : pe[peak + 1];
+        }
+
+        memcpy(&res, &sp->result[i], sizeof(res));
+        res.analyzed++;
+        res.period = (float)w * (float)sp->config.decimation / k;
+        scallop = pid_spectrum_scallop(delta);
+        res.err_amp = sp->gain * sqrtf(pe[peak]) / scallop;
+        res.cv_amp = sp->gain * sqrtf(pu[peak]) / scallop;
+        res.ratio = total > 0 ? (float)(lobe / total) : 0.0f;
+        res.oscillating = (res.err_amp >= sp->config.amplitude) && (res.ratio >= sp->config.ratio);
+        if (res.oscillating)
+            flagged++;
+
+        __atomic_store_n(&sp->seq[i], sp->seq[i] + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(&sp->result[i], &res, sizeof(res));
+        __atomic_store_n(&sp->seq[i], sp->seq[i] + 1, __ATOMIC_RELEASE);
+    }
+    return flagged;
+}
+
+/**
+ * @brief analyse every loop, pid_rt_step_f signature, arg is a pid_spectrum_t
+ * 
+ * @param arg 
+ */
+void pid_spectrum_step(void *arg)
+{
+    pid_spectrum_t *sp = (pid_spectrum_t *)arg;
+
+    if (!sp || (__atomic_load_n(&sp->filled, __ATOMIC_ACQUIRE) < sp->config.window))
+        return;
+
+    __atomic_store_n(&sp->flagged, pid_spectrum_analyze(sp, 0, sp->count), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&sp->passes, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief consistent copy of the last result of a loop
+ * 
+ * @param sp 
+ * @param index 
+ * @param result 
+ * @return pid_result_t 
+ */
+pid_result_t pid_spectrum_get(pid_spectrum_t *sp, size_t index, pid_spectrum_result_t *result)
+{
+    uint32_t seq;
+
+    PID_RETURN_IF_NULL(sp);
+    PID_RETURN_IF_NULL(result);
+    if (!sp->result || (index >= sp->count))
+        return PID_ERROR;
+
+    for (;;)
+    {
+        seq = __atomic_load_n(&sp->seq[index], __ATOMIC_ACQUIRE);
+        if (seq & 1U)
+            continue;
+        memcpy(result, &sp->result[index], sizeof(pid_spectrum_result_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&sp->seq[index], __ATOMIC_RELAXED) == seq)
+            return PID_OK;
+    }
+}
+
+/**
+ * @brief release the context
+ * 
+ * @param sp 
+ */
+void pid_spectrum_destroy(pid_spectrum_t *sp)
+{
+    if (!sp)
+        return;
+
+    free(sp->err);
+    free(sp->cv);
+    free(sp->err_acc);
+    free(sp->cv_acc);
+    free(sp->hann);
+    free(sp->coeff);
+    free(sp->result);
+    free(sp->seq);
+    sp->err = NULL;
+    sp->cv = NULL;
+    sp->err_acc = NULL;
+    sp->cv_acc = NULL;
+    sp->hann = NULL;
+    sp->coeff = NULL;
+    sp->result = NULL;
+    sp->seq = NULL;
+    sp->count = 0;
+}
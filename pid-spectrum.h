@@ -0,0 +1,150 @@
+/**
+ * @file pid-spectrum.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief streaming oscillation detector
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * The control thread pushes e(k) and u(k) of every loop into a fixed size
+ * ring per loop (pid_spectrum_push_bank), decimated by config.decimation.
+ * The analysis (pid_spectrum_analyze) runs on another thread: the window
+ * of each loop is copied, the mean is removed, a Hann window is applied
+ * and a Goertzel bank evaluates the bins between min_period and
+ * max_period. The dominant bin of e gives the oscillation period and
+ * amplitude, a loop is flagged when the amplitude and the share of the
+ * band power around that bin (the bin and its two neighbours, the main lobe
+ * of the Hann window) exceed the thresholds.
+ *
+ * pid_spectrum_step() has the pid_rt_step_f signature: run it from a
+ * pid_rt runner with priority 0 and cpu set to a background core.
+ *
+ * Memory: 2 * window floats per loop plus one result per loop, allocated
+ * once by pid_spectrum_create.
+ */
+#ifndef __PID_SPECTRUM_H__
+#define __PID_SPECTRUM_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pid.h"
+
+#define PID_SPECTRUM_MAX_WINDOW (4096U)
+
+    typedef struct _pid_spectrum_config_t
+    {
+        uint32_t window;     // samples per window, <= PID_SPECTRUM_MAX_WINDOW
+        uint32_t decimation; // one sample pushed every decimation ticks
+        float min_period;    // shortest detected period, in ticks, >= 2 * decimation
+        float max_period;    // longest detected period, in ticks, <= window * decimation / 2
+        float amplitude;     // flag threshold of the amplitude of e
+        float ratio;         // flag threshold of the share of the band power around the dominant bin (0..1)
+    } pid_spectrum_config_t;
+
+    typedef struct _pid_spectrum_result_t
+    {
+        uint64_t analyzed; // number of analyses of the loop
+        float period;      // period of the dominant oscillation, in ticks
+        float err_amp;     // amplitude of e at the dominant frequency, corrected for the window scalloping
+        float cv_amp;      // amplitude of u at the dominant frequency, same correction as err_amp
+        float ratio;       // share of the band power of e around the dominant bin
+        uint8_t oscillating;
+    } pid_spectrum_result_t;
+
+    typedef struct _pid_spectrum_t
+    {
+        pid_spectrum_config_t config;
+        size_t count;   // number of loops
+        float *err;     // window * count ring of e, sample major: one push writes count contiguous floats
+        float *cv;      // window * count ring of u
+        float *err_acc; // sums of the decimation block, NULL without decimation
+        float *cv_acc;
+        uint32_t pos;    // next ring position, common to every loop
+        uint32_t filled; // valid samples in the rings
+        uint32_t phase;  // ticks accumulated in the decimation block
+
+        // analysis tables, read only after pid_spectrum_create
+        uint32_t bins;    // number of bins
+        uint32_t k_first; // dft index of the first bin
+        float gain;       // amplitude of a bin = gain * |X(k)|
+        float *hann;      // window
+        float *coeff;     // 2.cos(2.pi.k / window) of every bin
+
+        pid_spectrum_result_t *result; // one per loop, seqlock
+        uint32_t *seq;
+        uint64_t passes;  // completed analysis passes
+        uint64_t flagged; // loops flagged on the last pass
+    } pid_spectrum_t;
+
+    /**
+     * @brief fill a configuration with the default values
+     * window 256, no decimation, periods 4..128 ticks
+     * 
+     * @param config 
+     */
+    void pid_spectrum_config_default(pid_spectrum_config_t *config);
+
+    /**
+     * @brief allocate the rings and the tables of count loops
+     * 
+     * @param sp 
+     * @param config 
+     * @param count         number of loops
+     * @return pid_result_t 
+     */
+    pid_result_t pid_spectrum_create(pid_spectrum_t *sp, const pid_spectrum_config_t *config, size_t count);
+
+    /**
+     * @brief push e(k) and u(k) of count pid handlers, after the tick (control thread)
+     * 
+     * @param sp 
+     * @param pid           array of count handlers, eg: bank->pid
+     * @param count         must be the count of the context
+     * @return pid_result_t 
+     */
+    pid_result_t pid_spectrum_push_bank(pid_spectrum_t *sp, const pid_handle_t *pid, size_t count);
+
+    /**
+     * @brief analyse the windows of the loops [first, first + n) (analysis thread)
+     * 
+     * @param sp 
+     * @param first 
+     * @param n 
+     * @return size_t       number of flagged loops in the range, 0 until the window is full
+     */
+    size_t pid_spectrum_analyze(pid_spectrum_t *sp, size_t first, size_t n);
+
+    /**
+     * @brief analyse every loop, pid_rt_step_f signature, arg is a pid_spectrum_t
+     * 
+     * @param arg 
+     */
+    void pid_spectrum_step(void *arg);
+
+    /**
+     * @brief consistent copy of the last result of a loop
+     * 
+     * @param sp 
+     * @param index 
+     * @param result 
+     * @return pid_result_t 
+     */
+    pid_result_t pid_spectrum_get(pid_spectrum_t *sp, size_t index, pid_spectrum_result_t *result);
+
+    /**
+     * @brief release the context
+     * 
+     * @param sp 
+     */
+    void pid_spectrum_destroy(pid_spectrum_t *sp);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __PID_SPECTRUM_H__
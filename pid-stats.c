@@ -0,0 +1,190 @@
+#include "pid-stats.h"
+#include <stdlib.h>
+#include <math.h>
+
+/**
+ * @brief reset the statistics
+ * 
+ * @param stats 
+ * @param band          |e| <= band is not counted as a zero crossing
+ * @return pid_result_t 
+ */
+pid_result_t pid_stats_init(pid_stats_t *stats, float band)
+{
+    PID_RETURN_IF_NULL(stats);
+    if (!(band >= 0))
+        return PID_ERROR;
+
+    memset(stats, 0, sizeof(pid_stats_t));
+    stats->band = band;
+    return PID_OK;
+}
+
+/**
+ * @brief update the statistics with the last sample of pid, O(1)
+ * 
+ * @param stats 
+ * @param pid 
+ */
+void pid_stats_update(pid_stats_t *stats, const pid_handle_t *pid)
+{
+    const pid_control_t *ctrl = &pid->control;
+    // the history is shifted after the step: err[1] is e(k)
+    double e = ctrl->err[1];
+    float cv = ctrl->cv.buff[0];
+    double delta;
+    int8_t sign;
+
+    stats->samples++;
+    stats->iae += fabs(e) * ctrl->sample_time;
+    stats->ise += e * e * ctrl->sample_time;
+
+    delta = e - stats->mean;
+    stats->mean += delta / (double)stats->samples;
+    stats->m2 += delta * (e - stats->mean);
+
+    if (stats->samples > 1)
+        stats->travel += fabsf(cv - stats->last_cv);
+    stats->last_cv = cv;
+
+    // same conditions as the limitation of the step
+    if (ctrl->cv.high_limit.enable && (ctrl->cv.high_limit.value > 0) && (cv >= ctrl->cv.high_limit.value))
+        stats->sat_high++;
+    else if (ctrl->cv.low_limit.enable && (ctrl->cv.low_limit.value > 0) && (cv <= ctrl->cv.low_limit.value))
+        stats->sat_low++;
+
+    if (e > stats->band)
+        sign = 1;
+    else if (e < -stats->band)
+        sign = -1;
+    else
+        return;
+    if (stats->last_sign && (sign != stats->last_sign))
+        stats->crossings++;
+    stats->last_sign = sign;
+}
+
+/**
+ * @brief value of one metric
+ * 
+ * @param stats 
+ * @param metric 
+ * @return double       0 before the first sample
+ */
+double pid_stats_metric(const pid_stats_t *stats, pid_stats_metric_e metric)
+{
+    if (!stats || !stats->samples)
+        return 0;
+
+    switch (metric)
+    {
+    case PID_STATS_IAE:
+        return stats->iae;
+    case PID_STATS_ISE:
+        return stats->ise;
+    case PID_STATS_VARIANCE:
+        return (stats->samples > 1) ? stats->m2 / (double)(stats->samples - 1) : 0;
+    case PID_STATS_TRAVEL:
+        return stats->travel / (double)stats->samples;
+    case PID_STATS_SATURATION:
+        return (double)(stats->sat_high + stats->sat_low) / (double)stats->samples;
+    case PID_STATS_OSCILLATION:
+        return (double)stats->crossings / (double)stats->samples;
+    default:
+        return 0;
+    }
+}
+
+static void pid_stats_sift_down(double *score, size_t *index, size_t n, size_t i)
+{
+    for (;;)
+    {
+        size_t l = 2 * i + 1, r = l + 1, m = i;
+
+        if ((l < n) && (score[l] < score[m]))
+            m = l;
+        if ((r < n) && (score[r] < score[m]))
+            m = r;
+        if (m == i)
+            return;
+
+        double s = score[i];
+        size_t x = index[i];
+        score[i] = score[m];
+        index[i] = index[m];
+        score[m] = s;
+        index[m] = x;
+        i = m;
+    }
+}
+
+/**
+ * @brief the n statistics blocks with the largest metric, worst first
+ * 
+ * @param stats         array of count statistics blocks, eg: bank->stats
+ * @param count 
+ * @param metric 
+ * @param n             number of requested loops
+ * @param index         array of n indexes
+ * @param score         array of n metric values, can be NULL
+ * @return size_t       number of returned loops, min(n, count)
+ */
+size_t pid_stats_worst(const pid_stats_t *stats, size_t count, pid_stats_metric_e metric,
+                       size_t n, size_t *index, double *score)
+{
+    double *heap;
+    size_t size = 0;
+
+    if (!stats || !index || !n)
+        return 0;
+
+    heap = score ? score : (double *)malloc(n * sizeof(double));
+    if (!heap)
+        return 0;
+
+    // min heap of the n worst loops, the root is the best of them
+    for (size_t i = 0; i < count; i++)
+    {
+        double s = pid_stats_metric(&stats[i], metric);
+
+        if (size < n)
+        {
+            size_t c = size++;
+            heap[c] = s;
+            index[c] = i;
+            while (c && (heap[(c - 1) / 2] > heap[c]))
+            {
+                size_t p = (c - 1) / 2;
+                double t = heap[p];
+                size_t x = index[p];
+                heap[p] = heap[c];
+                index[p] = index[c];
+                heap[c] = t;
+                index[c] = x;
+                c = p;
+            }
+        }
+        else if (s > heap[0])
+        {
+            heap[0] = s;
+            index[0] = i;
+            pid_stats_sift_down(heap, index, size, 0);
+        }
+    }
+
+    // heap sort: pop the best to the end, the worst ends first
+    for (size_t end = size; end > 1; end--)
+    {
+        double t = heap[0];
+        size_t x = index[0];
+        heap[0] = heap[end - 1];
+        index[0] = index[end - 1];
+        heap[end - 1] = t;
+        index[end - 1] = x;
+        pid_stats_sift_down(heap, index, end - 1, 0);
+    }
+
+    if (!score)
+        free(heap);
+    return size;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file pid-stats.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief online loop performance assessment
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * pid_stats_update() is called after pid_on_processing() (the bank calls it
+ * when statistics are enabled), it costs a few floating point operations per
+ * tick and keeps no sample history.
+ */
+#ifndef __PID_STATS_H__
+#define __PID_STATS_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pid-typedef.h"
+
+    typedef enum _pid_stats_metric_e
+    {
+        PID_STATS_IAE = 0,     // integral of |e|
+        PID_STATS_ISE,         // integral of e^2
+        PID_STATS_VARIANCE,    // variance of e
+        PID_STATS_TRAVEL,      // output travel per sample
+        PID_STATS_SATURATION,  // fraction of the samples at a limitation
+        PID_STATS_OSCILLATION, // error zero crossings per sample
+        PID_STATS_METRIC_MAX,
+    } pid_stats_metric_e;
+
+    /**
+     * @brief statistics of one pid handler
+     */
+    typedef struct _pid_stats_t
+    {
+        uint64_t samples;   // number of updates
+        double iae;         // sum |e(k)|.T
+        double ise;         // sum e(k)^2.T
+        double mean;        // mean of e (Welford)
+        double m2;          // sum of the squared differences from the mean (Welford)
+        double travel;      // sum |u(k) - u(k-1)|
+        uint64_t sat_high;  // samples at the high limitation
+        uint64_t sat_low;   // samples at the low limitation
+        uint64_t crossings; // sign changes of e outside the band
+        float band;         // hysteresis of the zero crossing detection
+        float last_cv;      // u(k-1)
+        int8_t last_sign;   // sign of the last e outside the band, 0 if none
+    } pid_stats_t;
+
+    /**
+     * @brief reset the statistics
+     * 
+     * @param stats 
+     * @param band          |e| <= band is not counted as a zero crossing
+     * @return pid_result_t 
+     */
+    pid_result_t pid_stats_init(pid_stats_t *stats, float band);
+
+    /**
+     * @brief update the statistics with the last sample of pid, O(1)
+     * 
+     * @param stats 
+     * @param pid 
+     */
+    void pid_stats_update(pid_stats_t *stats, const pid_handle_t *pid);
+
+    /**
+     * @brief value of one metric
+     * 
+     * @param stats 
+     * @param metric 
+     * @return double       0 before the first sample
+     */
+    double pid_stats_metric(const pid_stats_t *stats, pid_stats_metric_e metric);
+
+    /**
+     * @brief the n statistics blocks with the largest metric, worst first
+     * 
+     * @param stats         array of count statistics blocks, eg: bank->stats
+     * @param count 
+     * @param metric 
+     * @param n             number of requested loops
+     * @param index         array of n indexes
+     * @param score         array of n metric values, can be NULL
+     * @return size_t       number of returned loops, min(n, count)
+     */
+    size_t pid_stats_worst(const pid_stats_t *stats, size_t count, pid_stats_metric_e metric,
+                           size_t n, size_t *index, double *score);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __PID_STATS_H__
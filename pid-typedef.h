@@ -17,6 +17,7 @@ extern "C"
 #endif
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "pid-common.h"
 
 #define PID_CV_MAX_POS_VALUE 1100U
@@ -52,6 +53,34 @@ extern "C"
         PID_AUTO_TUNING_PHASE
     } pid_operation_phase;
 
+    /**
+     * @brief discretization of the continuous pid controller
+     */
+    typedef enum _pid_discrete_method_e
+    {
+        PID_DISCRETE_TUSTIN = 0,     // trapezoidal integral and derivative
+        PID_DISCRETE_BACKWARD_EULER, // backward difference integral and derivative
+        PID_DISCRETE_FORWARD_EULER,  // forward difference integral, backward difference derivative
+        PID_DISCRETE_FILTERED_D,     // backward euler, derivative with a first order filter (tf)
+        PID_DISCRETE_MAX,
+    } pid_discrete_method_e;
+
+    /**
+     * @brief coefficients of the difference equation as functions of the
+     * sample interval, for pid_on_processing_dt (see pid-discrete.h)
+     * b[i] = c[i] + t[i].dt(k) + t1[i].dt(k-1) + r[i]/dt(k) + r1[i]/dt(k-1), i: b0, b1, b2
+     */
+    typedef struct _pid_dt_coeff_t
+    {
+        float c[3];
+        float t[3];
+        float t1[3];
+        float r[3];
+        float r1[3];
+        float a1;
+        float a2;
+    } pid_dt_coeff_t;
+
     typedef struct _pid_para_t
     {
         float kp; //
@@ -62,6 +91,11 @@ extern "C"
         float b0; // decrease pid controller variable
         float b1; // decrease pid controller variable
         float b2; // decrease pid controller variable
+        float a1; // u(k-1) coefficient
+        float a2; // u(k-2) coefficient
+
+        pid_discrete_method_e method; // discretization method of b0..b2, a1, a2
+        float tf;                     // derivative filter time constant (PID_DISCRETE_FILTERED_D)
 
         bool enable_p; // enable p in controller
         bool enable_i; // enable i in controller
@@ -76,6 +110,7 @@ extern "C"
 
     typedef pid_control_property_t pid_limit_t;
     typedef pid_control_property_t pid_gain_t;
+    typedef pid_control_property_t pid_rate_limit_t;
 
     typedef struct _pid_io_property_t
     {
@@ -108,8 +143,11 @@ extern "C"
     typedef struct _pid_control_t
     {
         float sv;                     // set value
-        float err[PID_ERR_BUFF_SIZE]; // difference between pv and sv; (err = pv - sv)
+        float err[PID_ERR_BUFF_SIZE]; // difference between sv and pv; (err = sv - pv)
         float sample_time;            // sample time
+        pid_dt_coeff_t dt_coeff;      // variable sample time coefficients, set by pid_extend_param_cal
+        float last_dt;                // previous interval of pid_on_processing_dt, 0 before the first call
+        float last_dt_inv;            // 1 / last_dt, 0 for PID_DISCRETE_FILTERED_D
 
         /**
          * @brief pid process value
@@ -127,6 +165,20 @@ extern "C"
          */
         cv_output_t cv_output;
 
+        /**
+         * @brief output stage, converts cv.buff[0] to the cv_output dac code
+         * @param rate  maximum output change, in percent per second
+         * @param slew  maximum dac code change per update
+         */
+        struct output_stage_t
+        {
+            pid_rate_limit_t rate; // output rate limitation (%/s)
+            pid_rate_limit_t slew; // dac code slew limitation (code/update)
+            float fraction;        // last output after rate limitation [0; 1]
+            uint32_t code;         // last dac code
+            bool valid;            // fraction and code hold a previous output
+        } output;
+
         struct cv_t
         {
             float max;                               // the maximum value of pid calculation (raw output of calculation)
@@ -139,12 +191,51 @@ extern "C"
         } cv;
 
         pid_operation_mode_e operation_mode; // pid operation mode / manual / auto mode
+
+        /**
+         * @brief event driven processing
+         * the calculation is skipped and the output is held while the error is
+         * inside the deadband and the pv change is below the threshold
+         */
+        struct event_t
+        {
+            bool enable;        // enable event driven processing
+            bool computed;      // the last sample was computed (not skipped)
+            float deadband;     // error deadband, same unit as pv
+            float pv_threshold; // pv change since the last computed sample
+            float last_pv;      // pv of the last computed sample
+        } event;
     } pid_control_t;
 
+    struct _pid_handle_t;
+
+    /**
+     * @brief step function selected by pid_arm
+     */
+    typedef pid_result_t (*pid_step_f)(struct _pid_handle_t *pid, float current_pv);
+
+    /**
+     * @brief block step function selected by pid_arm, n steps in one call
+     */
+    typedef pid_result_t (*pid_block_f)(struct _pid_handle_t *pid, const float *pv, float *cv, size_t n);
+
+    /**
+     * @brief constants derived from the configuration by pid_arm
+     */
+    typedef struct _pid_armed_t
+    {
+        pid_step_f step;   // specialized step function, NULL if the handler is not armed
+        pid_block_f block; // block version of step, NULL in event driven mode
+        float pv_span;   // pv.max - pv.min
+        float limit_h;   // active high limitation, +inf if disabled
+        float limit_l;   // active low limitation, -inf if disabled
+    } pid_armed_t;
+
     typedef struct _pid_handle_t
     {
         pid_para_t parameter;
         pid_control_t control;
+        pid_armed_t armed;
         pid_init_flag_e flag;                // indicating the pid init state
         pid_operation_phase operation_phase; // indicating the phase of pid controller
         pid_result_t err;
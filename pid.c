@@ -1,5 +1,6 @@
 #include "pid.h"
 #include <stdlib.h>
+#include <math.h>
 
 /**
  * @brief create new pid handler structure
@@ -8,7 +9,7 @@
  */
 pid_handle_t *pid_create_new()
 {
-    PID_LOG("create %d new pid handler\n", 1);
+    PID_LOGD("create %d new pid handler\n", 1);
     return ((pid_handle_t *)calloc(1, sizeof(pid_handle_t)));
 }
 
@@ -22,6 +23,7 @@ pid_handle_t *pid_create_new()
 pid_result_t pid_set_pid_type(pid_handle_t *pid, int pid_enable)
 {
     PID_RETURN_IF_NULL(pid);
+    pid_disarm(pid);
 
     pid->parameter.enable_p = false;
     pid->parameter.enable_i = false;
@@ -45,7 +47,7 @@ pid_result_t pid_set_pid_type(pid_handle_t *pid, int pid_enable)
 }
 
 /**
- * @brief set gain value to pid handler
+ * @brief set gain value to pid handler, run pid_extend_param_cal after it
  * 
  * @param pid 
  * @param gain 
@@ -54,11 +56,15 @@ pid_result_t pid_set_pid_type(pid_handle_t *pid, int pid_enable)
 pid_result_t pid_set_parameter(pid_handle_t *pid, pid_para_t *para)
 {
     PID_RETURN_IF_NULL(pid);
+    pid_disarm(pid);
     if (!para)
         return PID_ERROR;
 
     memcpy(&pid->parameter, para, sizeof(pid_para_t));
     pid->flag |= PID_INIT_PARA;
+    // the coefficients follow the gains at pid_extend_param_cal, pid_arm
+    // refuses the handler until then
+    pid->flag &= ~(PID_INIT_Bx | PID_INIT_DT);
     pid->err = PID_OK;
     return PID_OK;
 }
@@ -88,6 +94,7 @@ pid_result_t pid_set_operation_mode(pid_handle_t *pid, pid_operation_mode_e mode
 pid_result_t pid_set_output_ctrl_method(pid_handle_t *pid, pid_output_ctrl_method_e ctrl_method)
 {
     PID_RETURN_IF_NULL(pid);
+    pid_disarm(pid);
     pid->control.cv.output_ctrl_mt = ctrl_method;
     pid->flag |= PID_INIT_OUTPUT_CTRL;
     pid->err = PID_OK;
@@ -104,6 +111,7 @@ pid_result_t pid_set_output_ctrl_method(pid_handle_t *pid, pid_output_ctrl_metho
 pid_result_t pid_set_cv_limit_h(pid_handle_t *pid, pid_limit_t *high)
 {
     PID_RETURN_IF_NULL(pid);
+    pid_disarm(pid);
     memcpy(&pid->control.cv.high_limit, high, sizeof(pid_limit_t));
     pid->err = PID_OK;
     return PID_OK;
@@ -119,6 +127,7 @@ pid_result_t pid_set_cv_limit_h(pid_handle_t *pid, pid_limit_t *high)
 pid_result_t pid_set_cv_limit_l(pid_handle_t *pid, pid_limit_t *low)
 {
     PID_RETURN_IF_NULL(pid);
+    pid_disarm(pid);
     memcpy(&pid->control.cv.low_limit, low, sizeof(pid_limit_t));
     pid->err = PID_OK;
     return PID_OK;
@@ -165,6 +174,7 @@ pid_result_t pid_set_sv_value(pid_handle_t *pid, float sv)
 pid_result_t pid_set_pv_range(pid_handle_t *pid, float pv_max, float pv_min)
 {
     PID_RETURN_IF_NULL(pid);
+    pid_disarm(pid);
     pid->control.pv.max = pv_max;
     pid->control.pv.min = pv_min;
     pid->flag |= PID_INIT_PV_MIN_MAX;
@@ -183,6 +193,7 @@ pid_result_t pid_set_pv_range(pid_handle_t *pid, float pv_max, float pv_min)
 pid_result_t pid_set_cv_max_min(pid_handle_t *pid, float max, float min)
 {
     PID_RETURN_IF_NULL(pid);
+    pid_disarm(pid);
     pid->control.cv.max = max;
     pid->control.cv.min = min;
     pid->flag |= PID_INIT_CV_MIN_MAX;
@@ -191,63 +202,166 @@ pid_result_t pid_set_cv_max_min(pid_handle_t *pid, float max, float min)
 }
 
 /**
- * @brief configuration pid handler, run this function after setting all 
- * paraemter of pid controller. Or when pid parameter/ sample time is changed
+ * @brief set the sample time, run pid_extend_param_cal after changing it
  * 
  * @param pid 
+ * @param sample_time   sample time in second
  * @return pid_result_t 
  */
-pid_result_t pid_extend_param_cal(pid_handle_t *pid)
+pid_result_t pid_set_sample_time(pid_handle_t *pid, float sample_time)
 {
+    PID_RETURN_IF_NULL(pid);
+    pid_disarm(pid);
+    if (!(sample_time > 0))
+    {
+        pid->err = PID_ERR_S;
+        return PID_ERR_S;
+    }
+
+    pid->control.sample_time = sample_time;
+    pid->control.last_dt = 0;
+    pid->control.last_dt_inv = 0;
+    pid->flag &= ~PID_INIT_Bx;
+    pid->err = PID_OK;
+    return PID_OK;
+}
 
-    /** --------- "Tustin method"
-   b0 = Kd/T = Kd.Td/T
-   b1 = -(Kp + 2Kd/T) = -Kp(1 + 2Td/T)
-   b2 = Kp + Ki.T + Kd/T = Kp(1 + 1.T/Ti + Td/T)  
-   
-   u(k) = u(k-2) + b2.e(k) + b1.e(k-1) + b0.e(k-2);   
-   ------------------------------------------------------------------ 
-   b2 = Kp + Ki.T/2 + 2.Kd/T = Kp(1 + T/(2.Ti) + 2Td/T)
-   b1 =  Ki.T - 4Kd/T = Kp(T/Ti - 4Td/T)
-   b0 = -(Kp - Ki.T/2 - 2Kd/T = -Kp(1 - T/2.Ti - 2Td/T)
-
-   Ki = Kp/Ti
-   Kd = Kp*Td;
-*/
+/**
+ * @brief set event driven processing
+ * 
+ * @param pid 
+ * @param enable        enable / disable event driven processing
+ * @param deadband      the output is held while |sv - pv| <= deadband
+ * @param pv_threshold  and while the pv change since the last computed sample < pv_threshold
+ * @return pid_result_t 
+ */
+pid_result_t pid_set_event_mode(pid_handle_t *pid, bool enable, float deadband, float pv_threshold)
+{
     PID_RETURN_IF_NULL(pid);
+    pid_disarm(pid);
+    if ((deadband < 0) || (pv_threshold < 0))
+    {
+        pid->err = PID_ERR_LIMIT;
+        return PID_ERR_LIMIT;
+    }
 
-    pid->parameter.b0 = -pid->parameter.kp + pid->parameter.ki * pid->control.sample_time / 2.0 +
-                        2.0 * pid->parameter.kd / pid->control.sample_time;
+    pid->control.event.enable = enable;
+    pid->control.event.deadband = deadband;
+    pid->control.event.pv_threshold = pv_threshold;
+    pid->control.event.last_pv = pid->control.pv.value;
+    pid->err = PID_OK;
+    return PID_OK;
+}
 
-    pid->parameter.b1 = pid->parameter.kp * pid->control.sample_time - 4.0 * pid->parameter.kd / pid->control.sample_time;
+/**
+ * @brief set the discretization method, run pid_extend_param_cal after changing it
+ * 
+ * @param pid 
+ * @param method        discretization method
+ * @param tf            derivative filter time constant in second, PID_DISCRETE_FILTERED_D only
+ * @return pid_result_t 
+ */
+pid_result_t pid_set_discrete_method(pid_handle_t *pid, pid_discrete_method_e method, float tf)
+{
+    PID_RETURN_IF_NULL(pid);
+    pid_disarm(pid);
+    if (((unsigned)method >= PID_DISCRETE_MAX) || !(tf >= 0))
+    {
+        pid->err = PID_ERROR;
+        return PID_ERROR;
+    }
 
-    pid->parameter.b2 = pid->parameter.kp + pid->parameter.ki * pid->control.sample_time / 2.0 +
-                        2.0 * pid->parameter.kd / pid->control.sample_time;
+    pid->parameter.method = method;
+    pid->parameter.tf = tf;
+    pid->flag &= ~(PID_INIT_Bx | PID_INIT_DT);
+    pid->err = PID_OK;
+    return PID_OK;
+}
+
+/**
+ * @brief load coefficients computed beforehand (eg: constexpr pid_discrete_coeff),
+ * instead of pid_extend_param_cal
+ * 
+ * @param pid 
+ * @param coeff 
+ * @return pid_result_t 
+ */
+pid_result_t pid_set_coeff(pid_handle_t *pid, const pid_coeff_t *coeff)
+{
+    PID_RETURN_IF_NULL(pid);
+    pid_disarm(pid);
+    if (!coeff)
+        return PID_ERROR;
 
+    pid->parameter.b0 = coeff->b0;
+    pid->parameter.b1 = coeff->b1;
+    pid->parameter.b2 = coeff->b2;
+    pid->parameter.a1 = coeff->a1;
+    pid->parameter.a2 = coeff->a2;
     pid->flag |= PID_INIT_Bx;
+    // the variable sample time coefficients do not follow external coefficients
+    pid->flag &= ~PID_INIT_DT;
     pid->err = PID_OK;
     return PID_OK;
 }
 
 /**
- * @brief   on processing function
- *          call this function in the sample loop to execute pid controller
+ * @brief configuration pid handler, run this function after setting all 
+ * paraemter of pid controller. Or when pid parameter/ sample time is changed
+ * The coefficients of pid->parameter.method are described in pid-discrete.h
+ * 
+ * @param pid 
+ * @return pid_result_t 
+ */
+pid_result_t pid_extend_param_cal(pid_handle_t *pid)
+{
+    pid_coeff_t coeff;
+
+    PID_RETURN_IF_NULL(pid);
+    pid_disarm(pid);
+
+    if ((unsigned)pid->parameter.method >= PID_DISCRETE_MAX)
+    {
+        pid->err = PID_ERROR;
+        return PID_ERROR;
+    }
+
+    coeff = pid_discrete_coeff(pid->parameter.method, pid->parameter.kp, pid->parameter.ki,
+                               pid->parameter.kd, pid->parameter.tf, pid->control.sample_time);
+    if (pid_set_coeff(pid, &coeff) != PID_OK)
+        return pid->err;
+
+    pid->control.dt_coeff = pid_discrete_dt_coeff(pid->parameter.method, pid->parameter.kp, pid->parameter.ki,
+                                                  pid->parameter.kd);
+    pid->control.last_dt = 0;
+    pid->control.last_dt_inv = 0;
+    pid->flag |= PID_INIT_DT;
+    return PID_OK;
+}
+
+/**
+ * @brief generic step body with the coefficients as arguments, shared by the
+ * fixed rate and the variable sample time paths
  * 
  * @param pid 
  * @param current_pv 
+ * @param b0 
+ * @param b1 
+ * @param b2 
+ * @param a1 
+ * @param a2 
  * @return pid_result_t function result
  */
-pid_result_t pid_on_processing(pid_handle_t *pid, float current_pv)
+static inline pid_result_t pid_step_coeff(pid_handle_t *pid, float current_pv, float b0, float b1, float b2,
+                                          float a1, float a2)
 {
-    float pv_sub = 0, limit_sub = 0, h = 0, l = 0;
-    PID_RETURN_IF_NULL(pid);
+    float pv_sub = 0;
 
     pid->control.pv.value = current_pv;
 
     pv_sub = pid->control.pv.max - pid->control.pv.min;
-    limit_sub = h - l;
 
-    if (pv_sub > 0 & limit_sub > 0)
+    if (pv_sub > 0)
     {
         pid->control.pv.percent = pid->control.pv.value / pv_sub;
     }
@@ -256,7 +370,7 @@ pid_result_t pid_on_processing(pid_handle_t *pid, float current_pv)
 
     /**
      * @brief 
-     * u(k) = u(k-2) + b2.e(k) + b1.e(k-1) + b0.e(k-2);
+     * u(k) = a1.u(k-1) + a2.u(k-2) + b2.e(k) + b1.e(k-1) + b0.e(k-2);
      * 1. calculate the err = e(k)
      * 2. calculating the cv[0] = u(k)
      * 3. checking the output limitation
@@ -265,12 +379,37 @@ pid_result_t pid_on_processing(pid_handle_t *pid, float current_pv)
      */
 
     // 1.
+    pid->control.err[0] = pid->control.sv - pid->control.pv.value;
+
+    // steady state: hold the output, keep the history flat so the next
+    // computed sample starts from the held output without a bump
+    if (pid->control.event.enable)
+    {
+        if ((fabsf(pid->control.err[0]) <= pid->control.event.deadband) &&
+            (fabsf(current_pv - pid->control.event.last_pv) < pid->control.event.pv_threshold))
+        {
+            pid->control.err[2] = pid->control.err[1] = pid->control.err[0];
+            pid->control.cv.buff[2] = pid->control.cv.buff[1] = pid->control.cv.buff[0];
+            pid->control.event.computed = false;
+            pid->err = PID_OK;
+            return PID_OK;
+        }
+        pid->control.event.last_pv = current_pv;
+    }
+    pid->control.event.computed = true;
 
-    // 2.
-    pid->control.cv.buff[0] = pid->control.cv.buff[2] + pid->parameter.b0 * pid->control.err[2] +
-                              pid->parameter.b1 * pid->control.err[1] + pid->parameter.b2 * pid->control.err[0];
+    // 2. a1 == 0 and a2 == 1 for Tustin, u(k-1) is only added for the other methods
+    pid->control.cv.buff[0] = a2 * pid->control.cv.buff[2];
+    if (a1 != 0)
+        pid->control.cv.buff[0] = pid->control.cv.buff[0] + a1 * pid->control.cv.buff[1];
+    pid->control.cv.buff[0] = pid->control.cv.buff[0] + b0 * pid->control.err[2] +
+                              b1 * pid->control.err[1] + b2 * pid->control.err[0];
 
     // 3.
+    if ((pid->control.cv.output_ctrl_mt == PID_METHOD_POSITIVE) && (pid->control.cv.buff[0] < 0))
+    {
+        pid->control.cv.buff[0] = 0;
+    }
     if (pid->control.cv.high_limit.enable)
     {
         if ((pid->control.cv.buff[0] > pid->control.cv.high_limit.value) && (pid->control.cv.high_limit.value > 0))
@@ -282,7 +421,7 @@ pid_result_t pid_on_processing(pid_handle_t *pid, float current_pv)
     {
         if ((pid->control.cv.buff[0] < pid->control.cv.low_limit.value) && (pid->control.cv.low_limit.value > 0))
         {
-            pid->control.cv.buff[0] = pid->control.cv.high_limit.value;
+            pid->control.cv.buff[0] = pid->control.cv.low_limit.value;
         }
     }
 
@@ -300,49 +439,483 @@ pid_result_t pid_on_processing(pid_handle_t *pid, float current_pv)
 }
 
 /**
- * @brief create default pid instance
+ * @brief generic step function, used when the handler is not armed
  * 
- * @param pid           pointer to pid pointer
+ * @param pid 
+ * @param current_pv 
+ * @return pid_result_t function result
+ */
+static pid_result_t pid_step_generic(pid_handle_t *pid, float current_pv)
+{
+    return pid_step_coeff(pid, current_pv, pid->parameter.b0, pid->parameter.b1, pid->parameter.b2,
+                          pid->parameter.a1, pid->parameter.a2);
+}
+
+/**
+ * @brief armed step function body, the configuration dependent branches
+ * are resolved at compile time for each kernel below
+ * 
+ * @param pid 
+ * @param current_pv 
+ * @param full          false when b1 == 0 (P controller), the e(k-1) term is dropped
+ * @param recursive     a1 != 0, the u(k-1) term is added
+ * @param positive      PID_METHOD_POSITIVE, the output is not negative
+ * @param limits        at least one of the output limitations is active
  * @return pid_result_t 
  */
-pid_result_t pid_create_new_default(pid_handle_t **pid)
+static inline pid_result_t pid_step_armed(pid_handle_t *pid, float current_pv,
+                                          const bool full, const bool recursive, const bool positive,
+                                          const bool limits)
 {
-    pid_result_t err = PID_ERROR;
+    pid_control_t *ctrl = &pid->control;
+    const pid_para_t *para = &pid->parameter;
+    float u;
+
+    ctrl->pv.value = current_pv;
+    ctrl->pv.percent = current_pv / pid->armed.pv_span;
+    ctrl->err[0] = ctrl->sv - current_pv;
+    ctrl->event.computed = true;
+
+    // same evaluation order as pid_step_generic, the results are bit identical
+    u = para->a2 * ctrl->cv.buff[2];
+    if (recursive)
+        u = u + para->a1 * ctrl->cv.buff[1];
+    u = u + para->b0 * ctrl->err[2];
+    if (full)
+        u = u + para->b1 * ctrl->err[1];
+    u = u + para->b2 * ctrl->err[0];
+
+    if (positive && (u < 0))
+        u = 0;
+    if (limits)
+    {
+        if (u > pid->armed.limit_h)
+            u = pid->armed.limit_h;
+        if (u < pid->armed.limit_l)
+            u = pid->armed.limit_l;
+    }
+
+    ctrl->cv.buff[2] = ctrl->cv.buff[1];
+    ctrl->cv.buff[1] = u;
+    ctrl->cv.buff[0] = u;
+    ctrl->err[2] = ctrl->err[1];
+    ctrl->err[1] = ctrl->err[0];
+
+    pid->err = PID_OK;
+    return PID_OK;
+}
+
+#define PID_DEFINE_KERNEL(name, full, recursive, positive, limits)         \
+    static pid_result_t name(pid_handle_t *pid, float current_pv)            \
+    {                                                                        \
+        return pid_step_armed(pid, current_pv, full, recursive, positive, limits); \
+    }
+
+PID_DEFINE_KERNEL(pid_step_p_bio, false, false, false, false)
+PID_DEFINE_KERNEL(pid_step_p_bio_limit, false, false, false, true)
+PID_DEFINE_KERNEL(pid_step_p_pos, false, false, true, false)
+PID_DEFINE_KERNEL(pid_step_p_pos_limit, false, false, true, true)
+PID_DEFINE_KERNEL(pid_step_pid_bio, true, false, false, false)
+PID_DEFINE_KERNEL(pid_step_pid_bio_limit, true, false, false, true)
+PID_DEFINE_KERNEL(pid_step_pid_pos, true, false, true, false)
+PID_DEFINE_KERNEL(pid_step_pid_pos_limit, true, false, true, true)
+PID_DEFINE_KERNEL(pid_step_rp_bio, false, true, false, false)
+PID_DEFINE_KERNEL(pid_step_rp_bio_limit, false, true, false, true)
+PID_DEFINE_KERNEL(pid_step_rp_pos, false, true, true, false)
+PID_DEFINE_KERNEL(pid_step_rp_pos_limit, false, true, true, true)
+PID_DEFINE_KERNEL(pid_step_rpid_bio, true, true, false, false)
+PID_DEFINE_KERNEL(pid_step_rpid_bio_limit, true, true, false, true)
+PID_DEFINE_KERNEL(pid_step_rpid_pos, true, true, true, false)
+PID_DEFINE_KERNEL(pid_step_rpid_pos_limit, true, true, true, true)
+
+/**
+ * @brief kernel table, [recursive][full][positive][limits]
+ * PI and PID share the same kernel, they only differ by their coefficients
+ */
+static const pid_step_f pid_kernel[2][2][2][2] = {
+    {
+        {{pid_step_p_bio, pid_step_p_bio_limit}, {pid_step_p_pos, pid_step_p_pos_limit}},
+        {{pid_step_pid_bio, pid_step_pid_bio_limit}, {pid_step_pid_pos, pid_step_pid_pos_limit}},
+    },
+    {
+        {{pid_step_rp_bio, pid_step_rp_bio_limit}, {pid_step_rp_pos, pid_step_rp_pos_limit}},
+        {{pid_step_rpid_bio, pid_step_rpid_bio_limit}, {pid_step_rpid_pos, pid_step_rpid_pos_limit}},
+    },
+};
+
+/**
+ * @brief armed block body, n steps of pid_step_armed with the history kept in
+ * locals, the expressions are the same so the results are bit identical
+ * 
+ * @param pid 
+ * @param pv            array of n process values
+ * @param cv            array of n outputs, can be NULL
+ * @param n             number of samples
+ * @param full          see pid_step_armed
+ * @param recursive 
+ * @param positive 
+ * @param limits 
+ * @return pid_result_t 
+ */
+static inline pid_result_t pid_block_armed(pid_handle_t *pid, const float *pv, float *cv, size_t n,
+                                           const bool full, const bool recursive, const bool positive,
+                                           const bool limits)
+{
+    pid_control_t *ctrl = &pid->control;
+    const float b0 = pid->parameter.b0, b1 = pid->parameter.b1, b2 = pid->parameter.b2;
+    const float a1 = pid->parameter.a1, a2 = pid->parameter.a2;
+    const float sv = ctrl->sv, limit_h = pid->armed.limit_h, limit_l = pid->armed.limit_l;
+    float e0 = ctrl->err[0], e1 = ctrl->err[1], e2 = ctrl->err[2];
+    float u = ctrl->cv.buff[0], u1 = ctrl->cv.buff[1], u2 = ctrl->cv.buff[2];
+    float x = ctrl->pv.value;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        x = pv[i];
+        e0 = sv - x;
+
+        u = a2 * u2;
+        if (recursive)
+            u = u + a1 * u1;
+        u = u + b0 * e2;
+        if (full)
+            u = u + b1 * e1;
+        u = u + b2 * e0;
+
+        if (positive && (u < 0))
+            u = 0;
+        if (limits)
+        {
+            if (u > limit_h)
+                u = limit_h;
+            if (u < limit_l)
+                u = limit_l;
+        }
+
+        u2 = u1;
+        u1 = u;
+        e2 = e1;
+        e1 = e0;
+        if (cv)
+            cv[i] = u;
+    }
+
+    if (n)
+    {
+        ctrl->pv.value = x;
+        ctrl->pv.percent = x / pid->armed.pv_span;
+        ctrl->err[0] = e0;
+        ctrl->err[1] = e1;
+        ctrl->err[2] = e2;
+        ctrl->cv.buff[0] = u;
+        ctrl->cv.buff[1] = u1;
+        ctrl->cv.buff[2] = u2;
+        ctrl->event.computed = true;
+    }
+    pid->err = PID_OK;
+    return PID_OK;
+}
+
+#define PID_DEFINE_BLOCK(name, full, recursive, positive, limits)                  \
+    static pid_result_t name(pid_handle_t *pid, const float *pv, float *cv, size_t n) \
+    {                                                                             \
+        return pid_block_armed(pid, pv, cv, n, full, recursive, positive, limits);   \
+    }
+
+PID_DEFINE_BLOCK(pid_block_p_bio, false, false, false, false)
+PID_DEFINE_BLOCK(pid_block_p_bio_limit, false, false, false, true)
+PID_DEFINE_BLOCK(pid_block_p_pos, false, false, true, false)
+PID_DEFINE_BLOCK(pid_block_p_pos_limit, false, false, true, true)
+PID_DEFINE_BLOCK(pid_block_pid_bio, true, false, false, false)
+PID_DEFINE_BLOCK(pid_block_pid_bio_limit, true, false, false, true)
+PID_DEFINE_BLOCK(pid_block_pid_pos, true, false, true, false)
+PID_DEFINE_BLOCK(pid_block_pid_pos_limit, true, false, true, true)
+PID_DEFINE_BLOCK(pid_block_rp_bio, false, true, false, false)
+PID_DEFINE_BLOCK(pid_block_rp_bio_limit, false, true, false, true)
+PID_DEFINE_BLOCK(pid_block_rp_pos, false, true, true, false)
+PID_DEFINE_BLOCK(pid_block_rp_pos_limit, false, true, true, true)
+PID_DEFINE_BLOCK(pid_block_rpid_bio, true, true, false, false)
+PID_DEFINE_BLOCK(pid_block_rpid_bio_limit, true, true, false, true)
+PID_DEFINE_BLOCK(pid_block_rpid_pos, true, true, true, false)
+PID_DEFINE_BLOCK(pid_block_rpid_pos_limit, true, true, true, true)
 
+/**
+ * @brief block kernel table, same layout as pid_kernel
+ */
+static const pid_block_f pid_block_kernel[2][2][2][2] = {
+    {
+        {{pid_block_p_bio, pid_block_p_bio_limit}, {pid_block_p_pos, pid_block_p_pos_limit}},
+        {{pid_block_pid_bio, pid_block_pid_bio_limit}, {pid_block_pid_pos, pid_block_pid_pos_limit}},
+    },
+    {
+        {{pid_block_rp_bio, pid_block_rp_bio_limit}, {pid_block_rp_pos, pid_block_rp_pos_limit}},
+        {{pid_block_rpid_bio, pid_block_rpid_bio_limit}, {pid_block_rpid_pos, pid_block_rpid_pos_limit}},
+    },
+};
+
+/**
+ * @brief validate the configuration and select the step function
+ * 
+ * @param pid 
+ * @return pid_result_t 
+ */
+pid_result_t pid_arm(pid_handle_t *pid)
+{
+    bool full, recursive, positive, limits;
     PID_RETURN_IF_NULL(pid);
 
-    *pid = pid_create_new();
-    pid_handle_t *new_pid = *pid;
+    pid_disarm(pid);
 
-    PID_RETURN_IF_NULL(new_pid);
+    if ((pid->flag & PID_INIT_ALL) != PID_INIT_ALL)
+    {
+        PID_LOG("pid is not fully configured, missing init flags 0x%02x\n",
+                (unsigned)(PID_INIT_ALL & ~(uint32_t)pid->flag));
+        pid->err = PID_ERROR;
+        return PID_ERROR;
+    }
+    if (!(pid->control.pv.max - pid->control.pv.min > 0))
+    {
+        PID_LOG("invalid pv range\n");
+        pid->err = PID_ERR_PV;
+        return PID_ERR_PV;
+    }
+    if (!(pid->control.sample_time > 0))
+    {
+        PID_LOG("invalid sample time\n");
+        pid->err = PID_ERR_S;
+        return PID_ERR_S;
+    }
+    if (!isfinite(pid->parameter.b0) || !isfinite(pid->parameter.b1) || !isfinite(pid->parameter.b2) ||
+        !isfinite(pid->parameter.a1) || !isfinite(pid->parameter.a2))
+    {
+        PID_LOG("invalid pid coefficients\n");
+        pid->err = PID_ERR_GAIN;
+        return PID_ERR_GAIN;
+    }
 
-    err = pid_set_pid_type(new_pid, PID_ENABLE_P | PID_ENABLE_I | PID_ENABLE_D);
+    pid->armed.pv_span = pid->control.pv.max - pid->control.pv.min;
+    pid->armed.limit_h = INFINITY;
+    pid->armed.limit_l = -INFINITY;
+    if (pid->control.cv.high_limit.enable && (pid->control.cv.high_limit.value > 0))
+        pid->armed.limit_h = pid->control.cv.high_limit.value;
+    if (pid->control.cv.low_limit.enable && (pid->control.cv.low_limit.value > 0))
+        pid->armed.limit_l = pid->control.cv.low_limit.value;
+
+    full = (pid->parameter.b1 != 0.0f);
+    recursive = (pid->parameter.a1 != 0.0f);
+    positive = (pid->control.cv.output_ctrl_mt == PID_METHOD_POSITIVE);
+    limits = isfinite(pid->armed.limit_h) || isfinite(pid->armed.limit_l);
+
+    // the event driven mode needs the checks of the generic step
+    if (pid->control.event.enable)
+    {
+        pid->armed.step = pid_step_generic;
+    }
+    else
+    {
+        pid->armed.step = pid_kernel[recursive][full][positive][limits];
+        pid->armed.block = pid_block_kernel[recursive][full][positive][limits];
+    }
 
-    err = pid_set_operation_mode(new_pid, PID_MANUAL_MODE);
+    pid->err = PID_OK;
+    return PID_OK;
+}
 
-    err = pid_set_output_ctrl_method(new_pid, PID_METHOD_POSITIVE);
+/**
+ * @brief drop the selected step function, the next pid_on_processing calls
+ * use the generic step until pid_arm is called again
+ * 
+ * @param pid 
+ */
+void pid_disarm(pid_handle_t *pid)
+{
+    if (pid)
+    {
+        pid->armed.step = NULL;
+        pid->armed.block = NULL;
+    }
+}
+
+/**
+ * @brief   on processing function
+ *          call this function in the sample loop to execute pid controller
+ * 
+ * @param pid 
+ * @param current_pv 
+ * @return pid_result_t function result
+ */
+pid_result_t pid_on_processing(pid_handle_t *pid, float current_pv)
+{
+    PID_RETURN_IF_NULL(pid);
+
+    if (pid->armed.step)
+        return pid->armed.step(pid, current_pv);
+    return pid_step_generic(pid, current_pv);
+}
+
+/**
+ * @brief run one sample with the measured interval since the previous one.
+ * The coefficients are evaluated from control.dt_coeff with one division per
+ * call; with a constant dt equal to the sample time the output follows
+ * pid_on_processing within the float rounding of the coefficients.
+ * The output limitations and the event driven mode behave as in
+ * pid_on_processing, the armed step function is not used
+ * 
+ * @param pid 
+ * @param current_pv 
+ * @param dt            interval since the previous sample in second, > 0
+ * @return pid_result_t PID_ERROR if pid_extend_param_cal was not run after the last
+ * parameter or method change, PID_ERR_S for an invalid dt
+ */
+pid_result_t pid_on_processing_dt(pid_handle_t *pid, float current_pv, float dt)
+{
+    const pid_dt_coeff_t *c;
+    float r, dt1, r1, al, be;
+    float b0, b1, b2, a1, a2;
+    pid_result_t ret;
+
+    PID_RETURN_IF_NULL(pid);
+    if (!(pid->flag & PID_INIT_DT))
+    {
+        pid->err = PID_ERROR;
+        return PID_ERROR;
+    }
+    if (!(dt > 0))
+    {
+        pid->err = PID_ERR_S;
+        return PID_ERR_S;
+    }
+
+    c = &pid->control.dt_coeff;
+    if (pid->parameter.method == PID_DISCRETE_FILTERED_D)
+    {
+        r = 1.0f / (pid->parameter.tf + dt);
+        al = pid->parameter.tf * r;
+        be = pid->parameter.kd * r;
+        b0 = pid->parameter.kp * al + be;
+        b1 = -pid->parameter.kp * (1 + al) - pid->parameter.ki * dt * al - 2.0f * be;
+        b2 = pid->parameter.kp + pid->parameter.ki * dt + be;
+        a1 = 1 + al;
+        a2 = -al;
+        r = 0; // 1 / dt is not needed by this method
+    }
+    else
+    {
+        r = 1.0f / dt;
+        // first sample: the previous interval is taken equal to this one
+        dt1 = pid->control.last_dt > 0 ? pid->control.last_dt : dt;
+        r1 = pid->control.last_dt > 0 ? pid->control.last_dt_inv : r;
+        b0 = c->c[0] + c->t[0] * dt + c->t1[0] * dt1 + c->r[0] * r + c->r1[0] * r1;
+        b1 = c->c[1] + c->t[1] * dt + c->t1[1] * dt1 + c->r[1] * r + c->r1[1] * r1;
+        b2 = c->c[2] + c->t[2] * dt + c->t1[2] * dt1 + c->r[2] * r + c->r1[2] * r1;
+        a1 = c->a1;
+        a2 = c->a2;
+    }
+
+    ret = pid_step_coeff(pid, current_pv, b0, b1, b2, a1, a2);
+    if (ret == PID_OK)
+    {
+        pid->control.last_dt = dt;
+        pid->control.last_dt_inv = r;
+    }
+    return ret;
+}
+
+/**
+ * @brief run n samples of one pid handler, the results are identical to n
+ * pid_on_processing calls. An armed handler runs the whole block with the
+ * history in registers, otherwise (event driven mode, not armed) each
+ * sample goes through pid_on_processing
+ * 
+ * @param pid 
+ * @param pv            array of n process values
+ * @param cv            array of n outputs (cv.buff[0] after each sample), can be NULL
+ * @param n             number of samples
+ * @return pid_result_t function result, the last error for the per sample path
+ */
+pid_result_t pid_on_processing_block(pid_handle_t *pid, const float *pv, float *cv, size_t n)
+{
+    pid_result_t err = PID_OK, ret;
+
+    PID_RETURN_IF_NULL(pid);
+    PID_RETURN_IF_NULL(pv);
+
+    if (pid->armed.step && pid->armed.block)
+        return pid->armed.block(pid, pv, cv, n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        ret = pid_on_processing(pid, pv[i]);
+        if (ret != PID_OK)
+            err = ret;
+        if (cv)
+            cv[i] = pid->control.cv.buff[0];
+    }
+    return err;
+}
+
+/**
+ * @brief apply the default configuration to an existing pid handler
+ * 
+ * @param pid 
+ * @return pid_result_t 
+ */
+pid_result_t pid_set_default(pid_handle_t *pid)
+{
+    pid_result_t err = PID_ERROR;
+
+    PID_RETURN_IF_NULL(pid);
+
+    err = pid_set_pid_type(pid, PID_ENABLE_P | PID_ENABLE_I | PID_ENABLE_D);
+
+    err = pid_set_operation_mode(pid, PID_MANUAL_MODE);
+
+    err = pid_set_output_ctrl_method(pid, PID_METHOD_POSITIVE);
 
     // default input is 0 - 2000
-    err = pid_set_pv_range(new_pid, 2000, 0);
+    err = pid_set_pv_range(pid, 2000, 0);
 
-    err = io_set_pv_input(new_pid, IO_0_5VDC, ADC_16IT);
+    err = io_set_pv_input(pid, IO_0_5VDC, ADC_16IT);
 
-    if (new_pid->control.cv.output_ctrl_mt == PID_METHOD_POSITIVE)
-        err = pid_set_cv_max_min(new_pid, PID_DEFAULT_MAX_CV, PID_DEFAULT_MIN_CV);
+    if (pid->control.cv.output_ctrl_mt == PID_METHOD_POSITIVE)
+        err = pid_set_cv_max_min(pid, PID_DEFAULT_MAX_CV, PID_DEFAULT_MIN_CV);
     else
-        err = pid_set_cv_max_min(new_pid, PID_DEFAULT_MAX_CV, -PID_DEFAULT_MAX_CV);
+        err = pid_set_cv_max_min(pid, PID_DEFAULT_MAX_CV, -PID_DEFAULT_MAX_CV);
 
-    err = io_set_cv_output(new_pid, IO_4_20mA, ADC_16IT);
+    err = io_set_cv_output(pid, IO_4_20mA, ADC_16IT);
 
     pid_limit_t limit = {110.0f, true};
 
-    err = pid_set_cv_limit_h(new_pid, &limit);
+    err = pid_set_cv_limit_h(pid, &limit);
 
     limit.value = 0;
-    err = pid_set_cv_limit_l(new_pid, &limit);
+    err = pid_set_cv_limit_l(pid, &limit);
 
     pid_gain_t gain = {PID_DEFAULT_GAIN, true};
-    err = pid_set_gain(new_pid, &gain);
+    err = pid_set_gain(pid, &gain);
+
+    pid->err = err;
+    return err;
+}
+
+/**
+ * @brief create default pid instance
+ * 
+ * @param pid           pointer to pid pointer
+ * @return pid_result_t 
+ */
+pid_result_t pid_create_new_default(pid_handle_t **pid)
+{
+    pid_result_t err = PID_ERROR;
+
+    PID_RETURN_IF_NULL(pid);
+
+    *pid = pid_create_new();
+    pid_handle_t *new_pid = *pid;
+
+    PID_RETURN_IF_NULL(new_pid);
+
+    err = pid_set_default(new_pid);
 
     pid_save_data(PID_BASE_EEPROM_ADDRESS, new_pid);
 
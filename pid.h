@@ -20,6 +20,7 @@ extern "C"
 #include <stdbool.h>
 #include "pid-io.h"
 #include "pid-eeprom.h"
+#include "pid-discrete.h"
     /**
      * @brief create new pid handler structure
      * 
@@ -37,7 +38,7 @@ extern "C"
     pid_result_t pid_set_pid_type(pid_handle_t *pid, int pid_enable);
 
     /**
-     * @brief set parameter value to pid handler
+     * @brief set parameter value to pid handler, run pid_extend_param_cal after it
      * 
      * @param pid 
      * @param para  pid parameter for kp, ki, kd 
@@ -119,6 +120,48 @@ extern "C"
      */
     pid_result_t pid_set_cv_max_min(pid_handle_t *pid, float max, float min);
 
+    /**
+     * @brief set the sample time, run pid_extend_param_cal after changing it
+     * 
+     * @param pid 
+     * @param sample_time   sample time in second
+     * @return pid_result_t 
+     */
+    pid_result_t pid_set_sample_time(pid_handle_t *pid, float sample_time);
+
+    /**
+     * @brief set event driven processing
+     * while the loop is at steady state, pid_on_processing skips the calculation
+     * and holds the output
+     * 
+     * @param pid 
+     * @param enable        enable / disable event driven processing
+     * @param deadband      the output is held while |sv - pv| <= deadband
+     * @param pv_threshold  and while the pv change since the last computed sample < pv_threshold
+     * @return pid_result_t 
+     */
+    pid_result_t pid_set_event_mode(pid_handle_t *pid, bool enable, float deadband, float pv_threshold);
+
+    /**
+     * @brief set the discretization method, run pid_extend_param_cal after changing it
+     * 
+     * @param pid 
+     * @param method        discretization method
+     * @param tf            derivative filter time constant in second, PID_DISCRETE_FILTERED_D only
+     * @return pid_result_t 
+     */
+    pid_result_t pid_set_discrete_method(pid_handle_t *pid, pid_discrete_method_e method, float tf);
+
+    /**
+     * @brief load coefficients computed beforehand (eg: constexpr pid_discrete_coeff),
+     * instead of pid_extend_param_cal
+     * 
+     * @param pid 
+     * @param coeff 
+     * @return pid_result_t 
+     */
+    pid_result_t pid_set_coeff(pid_handle_t *pid, const pid_coeff_t *coeff);
+
     /**
      * @brief configuration pid handler, run this function after setting all 
      * paraemter of pid controller. Or when pid parameter/ sample time is changed
@@ -128,6 +171,26 @@ extern "C"
      */
     pid_result_t pid_extend_param_cal(pid_handle_t *pid);
 
+    /**
+     * @brief validate the configuration once and select a specialized step
+     * function for it (P/PI/PID, Tustin/recursive methods, POSITIVE/BIO, limitation on/off).
+     * Run this function after pid_extend_param_cal, every setter changing the
+     * configuration disarms the handler
+     * 
+     * @param pid 
+     * @return pid_result_t PID_ERROR if an init flag of PID_INIT_ALL is missing,
+     *                      PID_ERR_PV / PID_ERR_S / PID_ERR_GAIN for invalid values
+     */
+    pid_result_t pid_arm(pid_handle_t *pid);
+
+    /**
+     * @brief drop the selected step function, the next pid_on_processing calls
+     * use the generic step until pid_arm is called again
+     * 
+     * @param pid 
+     */
+    void pid_disarm(pid_handle_t *pid);
+
     /**
      * @brief   on processing function
      *          call this function in the sample loop to execute pid controller
@@ -138,6 +201,45 @@ extern "C"
      */
     pid_result_t pid_on_processing(pid_handle_t *pid, float current_pv);
 
+    /**
+     * @brief run one sample with the measured interval since the previous one.
+     * The coefficients are evaluated from control.dt_coeff with one division per
+     * call; with a constant dt equal to the sample time the output follows
+     * pid_on_processing within the float rounding of the coefficients.
+     * The output limitations and the event driven mode behave as in
+     * pid_on_processing, the armed step function is not used
+     * 
+     * @param pid 
+     * @param current_pv 
+     * @param dt            interval since the previous sample in second, > 0
+     * @return pid_result_t PID_ERROR if pid_extend_param_cal was not run after the last
+     * parameter or method change, PID_ERR_S for an invalid dt
+     */
+    pid_result_t pid_on_processing_dt(pid_handle_t *pid, float current_pv, float dt);
+
+    /**
+     * @brief run n samples of one pid handler, the results are identical to n
+     * pid_on_processing calls. An armed handler runs the whole block with the
+     * history in registers, otherwise (event driven mode, not armed) each
+     * sample goes through pid_on_processing
+     * 
+     * @param pid 
+     * @param pv            array of n process values
+     * @param cv            array of n outputs (cv.buff[0] after each sample), can be NULL
+     * @param n             number of samples
+     * @return pid_result_t function result, the last error for the per sample path
+     */
+    pid_result_t pid_on_processing_block(pid_handle_t *pid, const float *pv, float *cv, size_t n);
+
+    /**
+     * @brief apply the default configuration to an existing pid handler,
+     * without saving it to eeprom
+     * 
+     * @param pid 
+     * @return pid_result_t 
+     */
+    pid_result_t pid_set_default(pid_handle_t *pid);
+
     /**
      * @brief create default pid instance
      * 
@@ -1,3 +1,4 @@
+#define PID_LOG_LEVEL PID_LOG_LEVEL_INFO
 #include "pid_controller.h"
 #include "pid.h"
 
@@ -7,9 +8,11 @@ int main()
 
     auto err = pid_create_new_default(&pid);
 
-    PID_LOG("sizeof(*pid) = %ld\n", sizeof(*pid));
+    PID_LOGI("sizeof(*pid) = %ld\n", sizeof(*pid));
 
-    PID_LOG("pid pv.max =%.2f\npid->err = %d", pid->control.pv.max, pid->err);
+    PID_LOGI("pid pv.max =%.2f\npid->err = %d\n", pid->control.pv.max, pid->err);
+
+    pid_log_drain(stdout);
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,311 @@
+#include "pid_coro.h"
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <exception>
+
+namespace pid
+{
+    namespace coro
+    {
+        void Task::promise_type::unhandled_exception()
+        {
+            PID_LOG("unhandled exception in control task\n");
+            std::terminate();
+        }
+
+        Task::~Task()
+        {
+            // a task which was never spawned still owns its frame
+            if (handle_)
+                handle_.destroy();
+        }
+
+        Timer::~Timer()
+        {
+            if (armed_ && loop_)
+                loop_->cancel_timer(this);
+        }
+
+        Waiter::~Waiter()
+        {
+            if (channel_)
+                channel_->remove_waiter(this);
+        }
+
+        /**
+         * @brief Loop
+         */
+        Loop::Loop()
+        {
+            epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+            timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+            if ((epoll_fd_ < 0) || (timer_fd_ < 0))
+            {
+                PID_LOG("can not create epoll / timerfd, errno %d\n", errno);
+                return;
+            }
+
+            struct epoll_event ev = {};
+            ev.events = EPOLLIN;
+            ev.data.fd = timer_fd_;
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &ev);
+        }
+
+        Loop::~Loop()
+        {
+            // destroy the frames of the unfinished tasks, their awaiters
+            // unlink themselves from channels and timers
+            for (auto &entry : timers_)
+                entry.second->armed_ = false;
+            timers_.clear();
+            ready_.clear();
+            for (void *address : tasks_)
+                std::coroutine_handle<>::from_address(address).destroy();
+            tasks_.clear();
+
+            if (timer_fd_ >= 0)
+                close(timer_fd_);
+            if (epoll_fd_ >= 0)
+                close(epoll_fd_);
+        }
+
+        void Loop::spawn(Task task)
+        {
+            std::coroutine_handle<> h = task.handle_;
+            task.handle_ = nullptr;
+            tasks_.insert(h.address());
+            schedule(h);
+        }
+
+        void Loop::add_timer(Timer *timer, clock::time_point when)
+        {
+            if (timer->armed_)
+                cancel_timer(timer);
+            timer->loop_ = this;
+            timer->it_ = timers_.emplace(when, timer);
+            timer->armed_ = true;
+        }
+
+        void Loop::cancel_timer(Timer *timer)
+        {
+            if (timer->armed_)
+            {
+                timers_.erase(timer->it_);
+                timer->armed_ = false;
+            }
+        }
+
+        void Loop::SleepAwaiter::await_suspend(std::coroutine_handle<> h)
+        {
+            handle = h;
+            loop_->add_timer(this, when);
+        }
+
+        void Loop::SleepAwaiter::fire()
+        {
+            loop_->schedule(handle);
+        }
+
+        Loop::SleepAwaiter Loop::sleep_for(clock::duration d)
+        {
+            return sleep_until(clock::now() + d);
+        }
+
+        Loop::SleepAwaiter Loop::sleep_until(clock::time_point t)
+        {
+            SleepAwaiter awaiter;
+            awaiter.loop_ = this;
+            awaiter.when = t;
+            return awaiter;
+        }
+
+        void Loop::resume_ready()
+        {
+            while (!ready_.empty())
+            {
+                std::coroutine_handle<> h = ready_.front();
+                ready_.pop_front();
+                h.resume();
+                if (h.done())
+                {
+                    tasks_.erase(h.address());
+                    h.destroy();
+                }
+            }
+        }
+
+        bool Loop::arm()
+        {
+            struct itimerspec its = {};
+
+            if (!timers_.empty())
+            {
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              timers_.begin()->first.time_since_epoch())
+                              .count();
+                // an absolute time of 0 would disarm the timer
+                if (ns <= 0)
+                    ns = 1;
+                its.it_value.tv_sec = ns / 1000000000;
+                its.it_value.tv_nsec = ns % 1000000000;
+            }
+            return timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &its, NULL) == 0;
+        }
+
+        int Loop::run()
+        {
+            struct epoll_event ev;
+            uint64_t expirations;
+
+            if ((epoll_fd_ < 0) || (timer_fd_ < 0))
+                return -1;
+
+            stop_ = false;
+            while (!stop_)
+            {
+                resume_ready();
+                if (stop_)
+                    break;
+
+                if (!arm())
+                {
+                    PID_LOG("timerfd_settime failed, errno %d\n", errno);
+                    return -1;
+                }
+
+                int n = epoll_wait(epoll_fd_, &ev, 1, -1);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    PID_LOG("epoll_wait failed, errno %d\n", errno);
+                    return -1;
+                }
+                if (n > 0 && ev.data.fd == timer_fd_)
+                {
+                    if (read(timer_fd_, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+                        return -1;
+                }
+
+                // fire every timer which is due, timers added by fire() with
+                // a deadline in the past are fired in the same pass
+                clock::time_point now = clock::now();
+                while (!timers_.empty() && timers_.begin()->first <= now)
+                {
+                    Timer *timer = timers_.begin()->second;
+                    timers_.erase(timers_.begin());
+                    timer->armed_ = false;
+                    timer->fire();
+                }
+            }
+            return 0;
+        }
+
+        /**
+         * @brief Channel
+         */
+        Channel::Channel(Loop &loop, pid_handle_t *pid, clock::duration period,
+                         std::function<float()> read_pv, std::function<void(float)> write_cv)
+            : loop_ref_(loop), pid_(pid), period_(period), read_pv_(std::move(read_pv)), write_cv_(std::move(write_cv))
+        {
+            next_ = clock::now() + period_;
+            loop_ref_.add_timer(this, next_);
+        }
+
+        Channel::~Channel()
+        {
+            while (head_)
+                remove_waiter(head_);
+        }
+
+        void Channel::add_waiter(Waiter *w, std::coroutine_handle<> h)
+        {
+            w->handle_ = h;
+            w->channel_ = this;
+            w->prev_ = nullptr;
+            w->next_ = head_;
+            if (head_)
+                head_->prev_ = w;
+            head_ = w;
+        }
+
+        void Channel::remove_waiter(Waiter *w)
+        {
+            if (w->channel_ != this)
+                return;
+            if (w->prev_)
+                w->prev_->next_ = w->next_;
+            else
+                head_ = w->next_;
+            if (w->next_)
+                w->next_->prev_ = w->prev_;
+            w->prev_ = w->next_ = nullptr;
+            w->channel_ = nullptr;
+        }
+
+        void Channel::fire()
+        {
+            // next deadline from the previous one, not from now: no drift
+            next_ += period_;
+            loop_ref_.add_timer(this, next_);
+
+            float pv = read_pv_ ? read_pv_() : pid_->control.pv.value;
+            result_ = pid_on_processing(pid_, pv);
+            if (write_cv_)
+                write_cv_(pid_->control.cv.buff[0]);
+            samples_++;
+
+            Waiter *w = head_;
+            while (w)
+            {
+                Waiter *next = w->next_;
+                if (w->on_sample(*this))
+                {
+                    remove_waiter(w);
+                    loop_ref_.schedule(w->handle_);
+                }
+                w = next;
+            }
+        }
+
+        void Channel::SampleAwaiter::await_suspend(std::coroutine_handle<> h)
+        {
+            ch.add_waiter(this, h);
+        }
+
+        void Channel::SettleAwaiter::await_suspend(std::coroutine_handle<> h)
+        {
+            ch.add_waiter(this, h);
+            ch.loop_ref_.add_timer(static_cast<Timer *>(this), clock::now() + timeout);
+        }
+
+        bool Channel::SettleAwaiter::on_sample(Channel &c)
+        {
+            float err = c.pid()->control.sv - c.pid()->control.pv.value;
+
+            if ((err <= band) && (err >= -band))
+                count++;
+            else
+                count = 0;
+
+            if (count >= samples)
+            {
+                settled = true;
+                c.loop_ref_.cancel_timer(static_cast<Timer *>(this));
+                return true;
+            }
+            return false;
+        }
+
+        void Channel::SettleAwaiter::fire()
+        {
+            // timeout
+            settled = false;
+            ch.remove_waiter(this);
+            ch.loop_ref_.schedule(Waiter::handle_);
+        }
+    } // namespace coro
+} // namespace pid
@@ -0,0 +1,265 @@
+/**
+ * @file pid_coro.h
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief C++20 coroutine layer for sample driven control tasks
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * All channels and tasks of a pid::coro::Loop run on the thread calling
+ * Loop::run(). The loop sleeps on a single timerfd armed to the earliest
+ * deadline, so thousands of channels and tasks share one core.
+ *
+ *  pid::coro::Task sequence(pid::coro::Loop &loop, pid::coro::Channel &ch)
+ *  {
+ *      for (float sv = 0; sv <= 500; sv += 5)
+ *      {
+ *          pid_set_sv_value(ch.pid(), sv);
+ *          co_await ch.next_sample();
+ *      }
+ *      if (!co_await ch.settled(2.0f, 50, std::chrono::seconds(30)))
+ *          pid_set_operation_mode(ch.pid(), PID_MANUAL_MODE);
+ *      co_await loop.sleep_for(std::chrono::seconds(5));
+ *  }
+ *
+ */
+#ifndef __PID_CORO_H__
+#define __PID_CORO_H__
+
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <functional>
+#include <map>
+#include <unordered_set>
+#include <cstddef>
+#include "pid.h"
+
+namespace pid
+{
+    namespace coro
+    {
+        using clock = std::chrono::steady_clock;
+
+        class Loop;
+        class Channel;
+
+        /**
+         * @brief fire and forget control task, owned by the loop once spawned
+         */
+        class Task
+        {
+        public:
+            struct promise_type
+            {
+                Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+                std::suspend_always initial_suspend() noexcept { return {}; }
+                std::suspend_always final_suspend() noexcept { return {}; }
+                void return_void() {}
+                void unhandled_exception();
+            };
+
+            Task(Task &&other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; }
+            Task(const Task &) = delete;
+            Task &operator=(const Task &) = delete;
+            ~Task();
+
+        private:
+            friend class Loop;
+            explicit Task(std::coroutine_handle<promise_type> h) : handle_(h) {}
+            std::coroutine_handle<promise_type> handle_;
+        };
+
+        /**
+         * @brief one shot deadline, kept in the loop timer queue
+         */
+        class Timer
+        {
+        public:
+            virtual ~Timer();
+            virtual void fire() = 0;
+
+        protected:
+            friend class Loop;
+            Loop *loop_ = nullptr;
+            std::multimap<clock::time_point, Timer *>::iterator it_;
+            bool armed_ = false;
+        };
+
+        /**
+         * @brief a coroutine suspended on the samples of a channel
+         */
+        class Waiter
+        {
+        public:
+            virtual ~Waiter();
+
+            /**
+             * @brief called on every sample of the channel
+             * @return true to resume the waiting coroutine
+             */
+            virtual bool on_sample(Channel &ch) = 0;
+
+        protected:
+            friend class Channel;
+            Channel *channel_ = nullptr;
+            Waiter *prev_ = nullptr;
+            Waiter *next_ = nullptr;
+            std::coroutine_handle<> handle_;
+        };
+
+        /**
+         * @brief single threaded event loop driven by timerfd / epoll
+         */
+        class Loop
+        {
+        public:
+            Loop();
+            ~Loop();
+            Loop(const Loop &) = delete;
+            Loop &operator=(const Loop &) = delete;
+
+            /**
+             * @brief take the ownership of a task and schedule its first run
+             */
+            void spawn(Task task);
+
+            /**
+             * @brief run channels and tasks until stop() is called
+             *
+             * @return int  0, or -1 if epoll / timerfd failed
+             */
+            int run();
+
+            /**
+             * @brief make run() return after the current iteration
+             */
+            void stop() { stop_ = true; }
+
+            /**
+             * @brief number of tasks which are not finished
+             */
+            size_t task_count() const { return tasks_.size(); }
+
+            struct SleepAwaiter : Timer
+            {
+                clock::time_point when;
+                std::coroutine_handle<> handle;
+
+                bool await_ready() const noexcept { return when <= clock::now(); }
+                void await_suspend(std::coroutine_handle<> h);
+                void await_resume() const noexcept {}
+                void fire() override;
+            };
+
+            /**
+             * @brief co_await loop.sleep_for(d): resume the task after d
+             */
+            SleepAwaiter sleep_for(clock::duration d);
+
+            /**
+             * @brief co_await loop.sleep_until(t): resume the task at t
+             */
+            SleepAwaiter sleep_until(clock::time_point t);
+
+            void add_timer(Timer *timer, clock::time_point when);
+            void cancel_timer(Timer *timer);
+            void schedule(std::coroutine_handle<> h) { ready_.push_back(h); }
+
+        private:
+            void resume_ready();
+            bool arm();
+
+            int epoll_fd_ = -1;
+            int timer_fd_ = -1;
+            bool stop_ = false;
+            std::unordered_set<void *> tasks_;
+            std::deque<std::coroutine_handle<>> ready_;
+            std::multimap<clock::time_point, Timer *> timers_;
+        };
+
+        /**
+         * @brief a pid controller sampled by the loop with a fixed period
+         * On every sample read_pv() is called, then pid_on_processing(), then
+         * write_cv() with the new control value, then the waiting tasks
+         */
+        class Channel : private Timer
+        {
+        public:
+            Channel(Loop &loop, pid_handle_t *pid, clock::duration period,
+                    std::function<float()> read_pv, std::function<void(float)> write_cv = nullptr);
+            ~Channel();
+            Channel(const Channel &) = delete;
+            Channel &operator=(const Channel &) = delete;
+
+            pid_handle_t *pid() const { return pid_; }
+            clock::duration period() const { return period_; }
+            pid_result_t result() const { return result_; }
+            uint64_t samples() const { return samples_; }
+
+            struct SampleAwaiter : Waiter
+            {
+                Channel &ch;
+
+                explicit SampleAwaiter(Channel &c) : ch(c) {}
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<> h);
+                pid_result_t await_resume() const noexcept { return ch.result(); }
+                bool on_sample(Channel &) override { return true; }
+            };
+
+            struct SettleAwaiter : Waiter, Timer
+            {
+                Channel &ch;
+                float band;
+                unsigned samples;
+                unsigned count = 0;
+                clock::duration timeout;
+                bool settled = false;
+
+                SettleAwaiter(Channel &c, float b, unsigned n, clock::duration t)
+                    : ch(c), band(b), samples(n), timeout(t) {}
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<> h);
+                bool await_resume() const noexcept { return settled; }
+                bool on_sample(Channel &c) override;
+                void fire() override;
+            };
+
+            /**
+             * @brief co_await ch.next_sample(): resume after the next sample,
+             * returns the pid_on_processing result of that sample
+             */
+            SampleAwaiter next_sample() { return SampleAwaiter(*this); }
+
+            /**
+             * @brief co_await ch.settled(band, n, timeout): resume once
+             * |sv - pv| <= band for n consecutive samples (true), or when the
+             * timeout expires (false)
+             */
+            SettleAwaiter settled(float band, unsigned samples, clock::duration timeout)
+            {
+                return SettleAwaiter(*this, band, samples, timeout);
+            }
+
+            void add_waiter(Waiter *w, std::coroutine_handle<> h);
+            void remove_waiter(Waiter *w);
+
+        private:
+            void fire() override;
+
+            Loop &loop_ref_;
+            pid_handle_t *pid_;
+            clock::duration period_;
+            clock::time_point next_;
+            std::function<float()> read_pv_;
+            std::function<void(float)> write_cv_;
+            pid_result_t result_ = PID_OK;
+            uint64_t samples_ = 0;
+            Waiter *head_ = nullptr;
+        };
+    } // namespace coro
+} // namespace pid
+
+#endif // __PID_CORO_H__
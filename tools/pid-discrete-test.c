@@ -0,0 +1,164 @@
+/**
+ * @file pid-discrete-test.c
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief response of every discretization method against the continuous pid
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * usage: pid-discrete-test
+ *
+ * A handler starts from rest and is driven with each pid_discrete_method_e,
+ * one term at a time. u(k) at t = k.T is compared to the continuous response:
+ *
+ *   P, step e = E      u = Kp.E                  |du| <= 1e-5.|u|
+ *   I, step e = E      u = Ki.E.t                |du| <= Ki.E.T + 1e-5.|u|
+ *   D, ramp e = R.t    u = Kd.R (t > 0)          |du| <= 1e-3.|u|
+ *   D filtered, step   u = Kd.E/Tf.exp(-t/Tf)    |du| <= Kd.E/Tf . T/Tf
+ *
+ * The integral tolerance is one sample of the integral: backward Euler
+ * leads the continuous response by one sample, Tustin by half a sample and
+ * forward Euler lags it by one sample. The unfiltered Tustin derivative
+ * alternates around Kd.R (pole at z = -1), the mean of two consecutive
+ * samples is checked instead. The filtered derivative bound is the error
+ * of its first sample, Kd.E/(Tf + T) against Kd.E/Tf.
+ *
+ * Returns 1 if a sample is out of its tolerance.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "../pid.h"
+
+#define TEST_T (0.01f)   // sample time
+#define TEST_TF (0.05f)  // derivative filter time constant
+#define TEST_SV (500.0f) // setpoint
+#define TEST_E (10.0f)   // error step
+#define TEST_R (100.0f)  // error ramp slope, per second
+#define TEST_SAMPLES (500)
+
+typedef enum
+{
+    TERM_P = 0,
+    TERM_I,
+    TERM_D,
+} term_e;
+
+static const char *method_name[] = {"tustin", "backward euler", "forward euler", "filtered d"};
+static const char *term_name[] = {"P", "I", "D"};
+
+static void setup(pid_handle_t *pid, pid_discrete_method_e method, term_e term)
+{
+    pid_para_t para;
+    float gain[3] = {0, 0, 0};
+
+    gain[term] = (term == TERM_P) ? 2.0f : (term == TERM_I) ? 5.0f : 0.02f;
+
+    memset(pid, 0, sizeof(pid_handle_t));
+    pid_set_default(pid);
+    memcpy(&para, &pid->parameter, sizeof(pid_para_t));
+    para.kp = gain[TERM_P];
+    para.ki = gain[TERM_I];
+    para.kd = gain[TERM_D];
+    pid_set_parameter(pid, &para);
+    pid_set_discrete_method(pid, method, TEST_TF);
+    pid_set_sample_time(pid, TEST_T);
+    pid_set_output_ctrl_method(pid, PID_METHOD_BIO);
+    pid->control.cv.high_limit.enable = false;
+    pid->control.cv.low_limit.enable = false;
+    pid_extend_param_cal(pid);
+    pid_set_sv_value(pid, TEST_SV);
+}
+
+/**
+ * @brief run one method and one term, print the worst sample
+ *
+ * @return int      number of samples out of tolerance
+ */
+static int check(pid_discrete_method_e method, term_e term)
+{
+    pid_handle_t pid;
+    float kp, ki, kd, t, u, u1 = 0, pv, ref, tol, dev, worst = 0;
+    int bad = 0;
+    bool ramp = (term == TERM_D) && (method != PID_DISCRETE_FILTERED_D);
+
+    setup(&pid, method, term);
+    kp = pid.parameter.kp;
+    ki = pid.parameter.ki;
+    kd = pid.parameter.kd;
+
+    for (int k = 0; k < TEST_SAMPLES; k++)
+    {
+        t = (float)k * TEST_T;
+        pv = ramp ? TEST_SV - TEST_R * t : TEST_SV - TEST_E;
+        if (pid_on_processing(&pid, pv) != PID_OK)
+        {
+            printf("%s %s: step failed at k = %d\n", method_name[method], term_name[term], k);
+            return 1;
+        }
+        u = pid.control.cv.buff[0];
+
+        switch (term)
+        {
+        case TERM_P:
+            ref = kp * TEST_E;
+            tol = 1e-5f * fabsf(ref);
+            break;
+
+        case TERM_I:
+            ref = ki * TEST_E * t;
+            tol = ki * TEST_E * TEST_T + 1e-5f * fabsf(ref);
+            break;
+
+        case TERM_D:
+        default:
+            if (!ramp)
+            {
+                ref = kd * TEST_E / TEST_TF * expf(-t / TEST_TF);
+                tol = kd * TEST_E / TEST_TF * TEST_T / TEST_TF;
+                break;
+            }
+            ref = kd * TEST_R;
+            tol = 1e-3f * fabsf(ref);
+            if (method == PID_DISCRETE_TUSTIN)
+            {
+                float mean = 0.5f * (u + u1);
+                u1 = u;
+                u = mean;
+            }
+            // the ramp starts at t = 0, its derivative is defined from the next sample
+            if (k == 0)
+                continue;
+            break;
+        }
+
+        dev = fabsf(u - ref);
+        if (dev > worst)
+            worst = dev;
+        if (!(dev <= tol))
+        {
+            if (!bad)
+                printf("%s %s: u(%d) = %g, expected %g +/- %g\n", method_name[method], term_name[term],
+                       k, u, ref, tol);
+            bad++;
+        }
+    }
+    printf("%-16s %s: worst |u - u(t)| %.3g, %d samples out of tolerance\n", method_name[method],
+           term_name[term], worst, bad);
+    return bad;
+}
+
+int main(void)
+{
+    int bad = 0;
+
+    for (int m = PID_DISCRETE_TUSTIN; m <= PID_DISCRETE_FILTERED_D; m++)
+    {
+        for (int term = TERM_P; term <= TERM_D; term++)
+            bad += check((pid_discrete_method_e)m, (term_e)term);
+    }
+
+    printf("%s\n", bad ? "FAILED" : "OK");
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,205 @@
+/**
+ * @file pid-dt-test.c
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief variable sample time processing against the fixed rate path
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * usage: pid-dt-test
+ *
+ * 1. closed loop, dt == sample_time: for every discretization method and a
+ *    P, PI and PID gain set, two handlers drive the same first order plant,
+ *    one with pid_on_processing and one with pid_on_processing_dt. The
+ *    largest output difference relative to the largest output has to stay
+ *    below 1e-4 (float rounding of the coefficients).
+ * 2. integral of a constant error with alternating intervals (5 ms / 15 ms):
+ *    backward Euler gives Ki.e.t, Tustin Ki.e.(t - dt(0) / 2).
+ * 3. backward Euler derivative of an error ramp with irregular intervals:
+ *    Kd times the slope at every sample.
+ * 4. the handler refuses pid_on_processing_dt after pid_set_parameter until
+ *    pid_extend_param_cal runs again, and pid_set_sample_time restarts the
+ *    interval history.
+ *
+ * Returns 1 if a check fails.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "../pid.h"
+
+#define TEST_T (0.01f)
+#define TEST_SV (500.0f)
+#define TEST_TICKS (20000)
+#define TEST_REL_BOUND (1e-4)
+
+static const char *method_name[] = {"tustin", "backward euler", "forward euler", "filtered d"};
+static const char *gain_name[] = {"P", "PI", "PID"};
+
+static void setup(pid_handle_t *pid, pid_discrete_method_e method, float kp, float ki, float kd)
+{
+    pid_para_t para;
+
+    memset(pid, 0, sizeof(pid_handle_t));
+    pid_set_default(pid);
+    memcpy(&para, &pid->parameter, sizeof(pid_para_t));
+    para.kp = kp;
+    para.ki = ki;
+    para.kd = kd;
+    pid_set_parameter(pid, &para);
+    pid_set_discrete_method(pid, method, 0.05f);
+    pid_set_sample_time(pid, TEST_T);
+    pid_set_output_ctrl_method(pid, PID_METHOD_BIO);
+    pid->control.cv.high_limit.enable = false;
+    pid->control.cv.low_limit.enable = false;
+    pid_extend_param_cal(pid);
+    pid_set_sv_value(pid, TEST_SV);
+}
+
+/**
+ * @brief 1. fixed rate and variable sample time paths in closed loop
+ */
+static int check_closed_loop(void)
+{
+    int bad = 0;
+
+    for (int m = PID_DISCRETE_TUSTIN; m <= PID_DISCRETE_FILTERED_D; m++)
+    {
+        for (int g = 0; g < 3; g++)
+        {
+            // the unfiltered Tustin derivative rings at the Nyquist frequency
+            // (pole at z = -1), its PID set keeps kd = 0
+            float kp = (g == 0) ? 0.05f : 0.2f;
+            float ki = (g == 0) ? 0.0f : (g == 1) ? 0.5f : 2.0f;
+            float kd = ((g == 2) && (m != PID_DISCRETE_TUSTIN)) ? 0.0005f : 0.0f;
+            pid_handle_t a, b;
+            float pa = 0, pb = 0;
+            double dev = 0, scale = 1, rel;
+
+            setup(&a, (pid_discrete_method_e)m, kp, ki, kd);
+            setup(&b, (pid_discrete_method_e)m, kp, ki, kd);
+            for (int k = 0; k < TEST_TICKS; k++)
+            {
+                if ((pid_on_processing(&a, pa) != PID_OK) || (pid_on_processing_dt(&b, pb, TEST_T) != PID_OK))
+                {
+                    printf("%s %s: step failed at k = %d\n", method_name[m], gain_name[g], k);
+                    return 1;
+                }
+                if (fabs((double)a.control.cv.buff[0] - b.control.cv.buff[0]) > dev)
+                    dev = fabs((double)a.control.cv.buff[0] - b.control.cv.buff[0]);
+                if (fabs(a.control.cv.buff[0]) > scale)
+                    scale = fabs(a.control.cv.buff[0]);
+                pa += 0.02f * (a.control.cv.buff[0] * 18.0f - pa);
+                pb += 0.02f * (b.control.cv.buff[0] * 18.0f - pb);
+            }
+            rel = dev / scale;
+            printf("%-16s %-3s: max |du| %.3g, relative %.3g\n", method_name[m], gain_name[g], dev, rel);
+            if (!(rel <= TEST_REL_BOUND))
+                bad++;
+        }
+    }
+    return bad;
+}
+
+/**
+ * @brief 2. integral of a constant error e = 1 with alternating intervals
+ */
+static int check_integral(void)
+{
+    int bad = 0;
+
+    for (int m = PID_DISCRETE_TUSTIN; m <= PID_DISCRETE_BACKWARD_EULER; m++)
+    {
+        pid_handle_t pid;
+        double t = 0, ref;
+        float dt = TEST_T, u;
+
+        setup(&pid, (pid_discrete_method_e)m, 0, 1.0f, 0);
+        for (int k = 0; k <= 1000; k++)
+        {
+            if (k > 0)
+                dt = (k & 1) ? 0.005f : 0.015f;
+            pid_on_processing_dt(&pid, TEST_SV - 1.0f, dt);
+            t += dt;
+        }
+        u = pid.control.cv.buff[0];
+        ref = (m == PID_DISCRETE_TUSTIN) ? t - TEST_T / 2.0 : t;
+        printf("%-16s I  : integral %.5f, expected %.5f\n", method_name[m], u, ref);
+        if (!(fabs(u - ref) <= 1e-4 * ref))
+            bad++;
+    }
+    return bad;
+}
+
+/**
+ * @brief 3. backward Euler derivative of e = -v.t with irregular intervals
+ */
+static int check_derivative(void)
+{
+    pid_handle_t pid;
+    double t = 0;
+    float dt, worst = 0;
+    int bad = 0;
+
+    setup(&pid, PID_DISCRETE_BACKWARD_EULER, 0, 0, 1.0f);
+    pid_on_processing_dt(&pid, TEST_SV, TEST_T);
+    for (int k = 0; k < 1000; k++)
+    {
+        dt = (k % 3 == 0) ? 0.02f : 0.005f;
+        t += dt;
+        pid_on_processing_dt(&pid, TEST_SV + 100.0f * (float)t, dt);
+        if (fabsf(pid.control.cv.buff[0] + 100.0f) > worst)
+            worst = fabsf(pid.control.cv.buff[0] + 100.0f);
+    }
+    printf("backward euler   D  : derivative of the ramp, worst |u + 100| %.3g\n", worst);
+    if (!(worst <= 0.5f))
+        bad++;
+    return bad;
+}
+
+/**
+ * @brief 4. stale table and interval history after a configuration change
+ */
+static int check_reconfigure(void)
+{
+    pid_handle_t pid;
+    pid_para_t para;
+    int bad = 0;
+
+    setup(&pid, PID_DISCRETE_BACKWARD_EULER, 0.2f, 0.5f, 0.0005f);
+    pid_on_processing_dt(&pid, 400, 0.02f);
+
+    memcpy(&para, &pid.parameter, sizeof(pid_para_t));
+    para.kp = 0.4f;
+    pid_set_parameter(&pid, &para);
+    if (pid_on_processing_dt(&pid, 400, TEST_T) != PID_ERROR)
+    {
+        printf("pid_on_processing_dt accepted the gains of pid_set_parameter without pid_extend_param_cal\n");
+        bad++;
+    }
+    pid_extend_param_cal(&pid);
+    pid_on_processing_dt(&pid, 400, 0.02f);
+
+    pid_set_sample_time(&pid, 0.005f);
+    if (pid.control.last_dt != 0)
+    {
+        printf("pid_set_sample_time kept the previous interval %g\n", pid.control.last_dt);
+        bad++;
+    }
+    printf("reconfiguration: %s\n", bad ? "failed" : "ok");
+    return bad;
+}
+
+int main(void)
+{
+    int bad = 0;
+
+    bad += check_closed_loop();
+    bad += check_integral();
+    bad += check_derivative();
+    bad += check_reconfigure();
+
+    printf("%s\n", bad ? "FAILED" : "OK");
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file pid-fleetgen-test.c
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief generated fleet step against pid_on_processing, bit for bit
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * usage: pid-fleetgen-test <config.csv> [ticks]
+ *
+ * Built by tools/pid-fleetgen-test.sh: the output of pid-fleetgen for the
+ * same configuration is included through FLEET_SOURCE, and the library, the
+ * generated file and this test are compiled with -ffp-contract=off.
+ *
+ * The configuration is loaded into a bank, then the bank and fleet_step()
+ * are driven for [ticks] ticks (default 20000) with the same pv sequence: a
+ * first order plant per loop fed back from its own output, a small
+ * deterministic ripple, and setpoint steps every 5000 ticks. The outputs are
+ * compared with memcmp every tick, the first mismatch is printed and the test
+ * returns 1.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../pid-loader.h"
+
+#ifndef FLEET_SOURCE
+#error "FLEET_SOURCE must name the file generated by pid-fleetgen"
+#endif
+#include FLEET_SOURCE
+
+int main(int argc, char **argv)
+{
+    static float pv_a[FLEET_COUNT], pv_b[FLEET_COUNT], cv_a[FLEET_COUNT], cv_b[FLEET_COUNT];
+    static float plant_a[FLEET_COUNT], plant_b[FLEET_COUNT];
+    uint32_t ticks;
+    pid_bank_t bank;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <config.csv> [ticks]\n", argv[0]);
+        return 1;
+    }
+    ticks = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 20000;
+
+    if (pid_loader_load(&bank, argv[1], 1, NULL) != PID_OK)
+    {
+        fprintf(stderr, "can not load %s\n", argv[1]);
+        return 1;
+    }
+    if (bank.count != FLEET_COUNT)
+    {
+        fprintf(stderr, "%u loops loaded, the generated step has %u\n", (unsigned)bank.count, FLEET_COUNT);
+        pid_bank_destroy(&bank);
+        return 1;
+    }
+
+    fleet_reset();
+    for (uint32_t t = 0; t < ticks; t++)
+    {
+        for (uint32_t i = 0; i < FLEET_COUNT; i++)
+        {
+            float ripple = (float)((t * 7 + i) % 13) * 0.01f;
+            pv_a[i] = plant_a[i] + ripple;
+            pv_b[i] = plant_b[i] + ripple;
+        }
+
+        for (uint32_t i = 0; i < FLEET_COUNT; i++)
+        {
+            pid_on_processing(&bank.pid[i], pv_a[i]);
+            cv_a[i] = bank.pid[i].control.cv.buff[0];
+        }
+        fleet_step(pv_b, cv_b);
+
+        if (memcmp(cv_a, cv_b, sizeof(cv_a)) != 0)
+        {
+            for (uint32_t i = 0; i < FLEET_COUNT; i++)
+            {
+                if (memcmp(&cv_a[i], &cv_b[i], sizeof(float)) != 0)
+                {
+                    printf("tick %u loop %u: pid_on_processing %a, fleet_step %a\n", t, i,
+                           (double)cv_a[i], (double)cv_b[i]);
+                    break;
+                }
+            }
+            printf("FAILED\n");
+            pid_bank_destroy(&bank);
+            return 1;
+        }
+
+        for (uint32_t i = 0; i < FLEET_COUNT; i++)
+        {
+            plant_a[i] += 0.02f * (cv_a[i] * 18.0f - plant_a[i]);
+            plant_b[i] += 0.02f * (cv_b[i] * 18.0f - plant_b[i]);
+        }
+        if (t % 5000 == 2500)
+        {
+            for (uint32_t i = 0; i < FLEET_COUNT; i++)
+            {
+                bank.pid[i].control.sv += 100.0f;
+                fleet_sv[i] += 100.0f;
+            }
+        }
+    }
+
+    printf("loops %u, ticks %u, outputs bit identical\nOK\n", FLEET_COUNT, ticks);
+    pid_bank_destroy(&bank);
+    return 0;
+}
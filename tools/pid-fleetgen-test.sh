@@ -0,0 +1,25 @@
+#!/bin/sh
+#
+# check that the step generated by pid-fleetgen is bit identical to
+# pid_on_processing, see tools/pid-fleetgen-test.c
+#
+# usage: tools/pid-fleetgen-test.sh [config.csv]
+#
+# The library, pid-fleetgen, the generated file and the test are all built
+# with -ffp-contract=off, CC and CFLAGS are taken from the environment.
+# Returns non zero on a build failure or on the first mismatching output.
+#
+set -e
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+config=${1:-$root/tools/pid-fleetgen-fixture.csv}
+cc=${CC:-cc}
+cflags="${CFLAGS:--O2} -std=gnu11 -ffp-contract=off -I$root"
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+$cc $cflags -o "$work/pid-fleetgen" "$root/tools/pid-fleetgen.c" "$root"/*.c -lm -lpthread
+"$work/pid-fleetgen" "$config" "$work/fleet.c"
+$cc $cflags -DFLEET_SOURCE="\"$work/fleet.c\"" -o "$work/pid-fleetgen-test" \
+    "$root/tools/pid-fleetgen-test.c" "$root"/*.c -lm -lpthread
+"$work/pid-fleetgen-test" "$config"
@@ -0,0 +1,188 @@
+/**
+ * @file pid-fleetgen.c
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief generate a flat C step function for a fixed fleet
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * usage: pid-fleetgen <config.csv> [output.c]
+ *
+ * The configuration file has the format of pid_loader_load. Every line is
+ * loaded and armed by the library, then the resolved constants (b0..b2,
+ * a1, a2, limitations, output method) are written as exact hexadecimal
+ * float literals into a self-contained C file:
+ *
+ *   float fleet_sv[FLEET_COUNT];                    setpoints, writable
+ *   void fleet_reset(void);                         clear the history
+ *   void fleet_step(const float *pv, float *cv);    one tick of every loop
+ *
+ * The history is statically allocated and fleet_step() is fully unrolled,
+ * with the expressions of the armed step of pid_on_processing in the same
+ * order: cv[i] is bit identical to cv.buff[0] of the loaded handler, as
+ * long as both are compiled with the same floating point contraction
+ * (-ffp-contract=off on targets with fused multiply add).
+ *
+ * The io conversions are not part of the step: pv is in engineering unit
+ * and cv in the unit of cv.buff, as for pid_on_processing.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../pid-loader.h"
+
+/**
+ * @brief print a float as an exact hexadecimal literal
+ */
+static void emit_float(FILE *out, float v)
+{
+    fprintf(out, "%af", (double)v);
+}
+
+static void emit_loop(FILE *out, size_t i, const pid_handle_t *pid)
+{
+    const pid_para_t *para = &pid->parameter;
+    bool full = (para->b1 != 0.0f);
+    bool recursive = (para->a1 != 0.0f);
+    bool positive = (pid->control.cv.output_ctrl_mt == PID_METHOD_POSITIVE);
+
+    fprintf(out, "\n    /* loop %zu */\n", i);
+    fprintf(out, "    e0 = fleet_sv[%zu] - pv[%zu];\n", i, i);
+    fprintf(out, "    u = ");
+    emit_float(out, para->a2);
+    fprintf(out, " * fleet_u2[%zu];\n", i);
+    if (recursive)
+    {
+        fprintf(out, "    u = u + ");
+        emit_float(out, para->a1);
+        fprintf(out, " * fleet_u1[%zu];\n", i);
+    }
+    fprintf(out, "    u = u + ");
+    emit_float(out, para->b0);
+    fprintf(out, " * fleet_e2[%zu];\n", i);
+    if (full)
+    {
+        fprintf(out, "    u = u + ");
+        emit_float(out, para->b1);
+        fprintf(out, " * fleet_e1[%zu];\n", i);
+    }
+    fprintf(out, "    u = u + ");
+    emit_float(out, para->b2);
+    fprintf(out, " * e0;\n");
+
+    if (positive)
+        fprintf(out, "    if (u < 0)\n        u = 0;\n");
+    // a disabled limitation is infinite in the armed handler, its comparison is never true
+    if (isfinite(pid->armed.limit_h))
+    {
+        fprintf(out, "    if (u > ");
+        emit_float(out, pid->armed.limit_h);
+        fprintf(out, ")\n        u = ");
+        emit_float(out, pid->armed.limit_h);
+        fprintf(out, ";\n");
+    }
+    if (isfinite(pid->armed.limit_l))
+    {
+        fprintf(out, "    if (u < ");
+        emit_float(out, pid->armed.limit_l);
+        fprintf(out, ")\n        u = ");
+        emit_float(out, pid->armed.limit_l);
+        fprintf(out, ";\n");
+    }
+
+    fprintf(out, "    fleet_u2[%zu] = fleet_u1[%zu];\n", i, i);
+    fprintf(out, "    fleet_u1[%zu] = u;\n", i);
+    fprintf(out, "    fleet_e2[%zu] = fleet_e1[%zu];\n", i, i);
+    fprintf(out, "    fleet_e1[%zu] = e0;\n", i);
+    fprintf(out, "    cv[%zu] = u;\n", i);
+}
+
+static void emit(FILE *out, const char *path, const pid_bank_t *bank)
+{
+    fprintf(out, "/*\n * generated by pid-fleetgen from %s, do not edit\n *\n", path);
+    fprintf(out, " * bit identical to pid_on_processing when compiled with the same floating\n");
+    fprintf(out, " * point contraction as the library (-ffp-contract=off on fma targets)\n */\n");
+    fprintf(out, "#include <string.h>\n\n");
+    fprintf(out, "#define FLEET_COUNT (%zuU)\n\n", bank->count);
+
+    fprintf(out, "float fleet_sv[FLEET_COUNT] = {\n");
+    for (size_t i = 0; i < bank->count; i++)
+    {
+        fprintf(out, "    ");
+        emit_float(out, bank->pid[i].control.sv);
+        fprintf(out, ",\n");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static float fleet_e1[FLEET_COUNT]; /* e(k-1) */\n");
+    fprintf(out, "static float fleet_e2[FLEET_COUNT]; /* e(k-2) */\n");
+    fprintf(out, "static float fleet_u1[FLEET_COUNT]; /* u(k-1) */\n");
+    fprintf(out, "static float fleet_u2[FLEET_COUNT]; /* u(k-2) */\n\n");
+
+    fprintf(out, "void fleet_reset(void)\n{\n");
+    fprintf(out, "    memset(fleet_e1, 0, sizeof(fleet_e1));\n");
+    fprintf(out, "    memset(fleet_e2, 0, sizeof(fleet_e2));\n");
+    fprintf(out, "    memset(fleet_u1, 0, sizeof(fleet_u1));\n");
+    fprintf(out, "    memset(fleet_u2, 0, sizeof(fleet_u2));\n}\n\n");
+
+    fprintf(out, "void fleet_step(const float *pv, float *cv)\n{\n");
+    fprintf(out, "    float e0, u;\n");
+    for (size_t i = 0; i < bank->count; i++)
+        emit_loop(out, i, &bank->pid[i]);
+    fprintf(out, "}\n");
+}
+
+int main(int argc, char **argv)
+{
+    pid_loader_stats_t stats;
+    pid_bank_t bank;
+    FILE *out = stdout;
+    int ret = 0;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <config.csv> [output.c]\n", argv[0]);
+        return 1;
+    }
+
+    if (pid_loader_load(&bank, argv[1], 1, &stats) != PID_OK)
+    {
+        pid_log_drain(stderr);
+        if (stats.failed)
+            fprintf(stderr, "%lu lines can not be loaded, first at line %lu\n",
+                    (unsigned long)stats.failed, (unsigned long)stats.first_line);
+        else
+            fprintf(stderr, "can not load %s\n", argv[1]);
+        pid_bank_destroy(&bank);
+        return 1;
+    }
+
+    // the step is generated from the armed kernel, the event driven mode is not supported
+    for (size_t i = 0; i < bank.count; i++)
+    {
+        if (!bank.pid[i].armed.step || bank.pid[i].control.event.enable)
+        {
+            fprintf(stderr, "loop %zu is not armed\n", i);
+            pid_bank_destroy(&bank);
+            return 1;
+        }
+    }
+
+    if ((argc > 2) && !(out = fopen(argv[2], "w")))
+    {
+        fprintf(stderr, "can not create %s\n", argv[2]);
+        pid_bank_destroy(&bank);
+        return 1;
+    }
+
+    emit(out, argv[1], &bank);
+    if (out != stdout)
+    {
+        if (fclose(out) != 0)
+            ret = 1;
+        fprintf(stderr, "%zu loops written to %s\n", bank.count, argv[2]);
+    }
+    pid_bank_destroy(&bank);
+    return ret;
+}
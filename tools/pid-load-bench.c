@@ -0,0 +1,67 @@
+/**
+ * @file pid-load-bench.c
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief startup time of the bulk configuration loader
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * usage: pid-load-bench <file> [loops] [threads]
+ *
+ * With loops > 0 a configuration file of loops lines is generated first.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "../pid-loader.h"
+
+static int generate(const char *path, uint32_t loops)
+{
+    FILE *f = fopen(path, "w");
+
+    if (!f)
+        return -1;
+    fprintf(f, "# generated by pid-load-bench\n");
+    fprintf(f, "kp,ki,kd,sample_time,sv,pv_min,pv_max,cv_min,cv_max,type,ctrl_method,mode,"
+               "pv_io,pv_resolution,cv_io,cv_resolution,limit_h,limit_l,gain,method,tf\n");
+    for (uint32_t i = 0; i < loops; i++)
+    {
+        fprintf(f, "%.3f,%.3f,%.4f,%.3f,%.1f,0,2000,0,11000,7,%u,1,%u,32768,5,32768,%s,,1.0,%u,%s\n",
+                1.0 + (i % 100) * 0.01, 0.1 + (i % 7) * 0.05, (i % 3) * 0.01, (i % 2) ? 0.01 : 0.1,
+                100.0 + (i % 1800), i % 2, i % 8, (i % 4) ? "110" : "", i % 4, (i % 4 == 3) ? "0.05" : "");
+    }
+    return fclose(f);
+}
+
+int main(int argc, char **argv)
+{
+    pid_loader_stats_t st;
+    pid_bank_t bank;
+    uint32_t loops = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 0;
+    uint32_t threads = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 0) : 0;
+    pid_result_t err;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <file> [loops] [threads]\n", argv[0]);
+        return 1;
+    }
+    if (loops && generate(argv[1], loops))
+    {
+        fprintf(stderr, "can not write %s\n", argv[1]);
+        return 1;
+    }
+
+    err = pid_loader_load(&bank, argv[1], threads, &st);
+    pid_log_drain(stderr);
+
+    printf("%llu lines, %llu loaded, %llu failed (first at line %llu), %u threads\n",
+           (unsigned long long)st.lines, (unsigned long long)st.loaded, (unsigned long long)st.failed,
+           (unsigned long long)st.first_line, st.threads);
+    printf("map %.3f ms, index %.3f ms, parse %.3f ms, total %.3f ms, %.0f ns/loop\n",
+           st.map_ns / 1e6, st.index_ns / 1e6, st.parse_ns / 1e6, st.total_ns / 1e6,
+           st.lines ? (double)st.total_ns / (double)st.lines : 0.0);
+
+    pid_bank_destroy(&bank);
+    return err == PID_OK ? 0 : 2;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file pid-loadtest.c
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief load test client of the batched command server
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * usage: pid-loadtest <socket path> <loops> <batch size> <iterations>
+ *        pid-loadtest --self <loops> <batch size> <iterations>
+ *
+ * --self starts an in-process bank of <loops> handlers, a server thread and a
+ * 1 ms tick thread applying the batches at the tick boundary.
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../pid-server.h"
+
+static volatile int running = 1;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void *server_thread(void *arg)
+{
+    pid_server_t *srv = (pid_server_t *)arg;
+
+    while (running)
+        pid_server_poll(srv, 10);
+    return NULL;
+}
+
+static void *tick_thread(void *arg)
+{
+    pid_server_t *srv = (pid_server_t *)arg;
+    struct timespec ts = {0, 1000000};
+    float *pv = (float *)calloc(srv->bank->count, sizeof(float));
+
+    while (running)
+    {
+        pid_server_on_tick(srv);
+        pid_bank_on_processing(srv->bank, pv);
+        nanosleep(&ts, NULL);
+    }
+    free(pv);
+    return NULL;
+}
+
+static int io_all(int fd, void *data, size_t size, int out)
+{
+    uint8_t *p = (uint8_t *)data;
+    ssize_t n;
+
+    while (size)
+    {
+        n = out ? send(fd, p, size, MSG_NOSIGNAL) : recv(fd, p, size, 0);
+        if (n <= 0)
+            return -1;
+        p += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv)
+{
+    pid_bank_t bank;
+    pid_server_t srv;
+    pthread_t server, tick;
+    struct sockaddr_un addr;
+    const char *path;
+    uint32_t loops, batch, iterations, failed = 0;
+    int self, fd;
+
+    if (argc < 5)
+    {
+        fprintf(stderr, "usage: %s <socket path | --self> <loops> <batch size> <iterations>\n", argv[0]);
+        return 1;
+    }
+    self = !strcmp(argv[1], "--self");
+    path = self ? "/tmp/pid-loadtest.sock" : argv[1];
+    loops = (uint32_t)strtoul(argv[2], NULL, 0);
+    batch = (uint32_t)strtoul(argv[3], NULL, 0);
+    iterations = (uint32_t)strtoul(argv[4], NULL, 0);
+    if (!loops || !batch || batch > PID_CMD_MAX_BATCH || !iterations)
+        return 1;
+
+    if (self)
+    {
+        if (pid_bank_create(&bank, loops) != PID_OK ||
+            pid_server_create(&srv, path, &bank, true) != PID_OK)
+            return 1;
+        pthread_create(&server, NULL, server_thread, &srv);
+        pthread_create(&tick, NULL, tick_thread, &srv);
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        perror("connect");
+        return 1;
+    }
+
+    size_t req_size = sizeof(pid_cmd_header_t) + batch * sizeof(pid_cmd_t);
+    uint8_t *req = (uint8_t *)malloc(req_size);
+    int32_t *result = (int32_t *)malloc(batch * sizeof(int32_t));
+    uint64_t *latency = (uint64_t *)malloc(iterations * sizeof(uint64_t));
+    pid_cmd_header_t *header = (pid_cmd_header_t *)req, rsp;
+    pid_cmd_t *cmd = (pid_cmd_t *)(req + sizeof(pid_cmd_header_t));
+
+    header->magic = PID_CMD_MAGIC;
+    header->count = batch;
+
+    uint64_t start = now_ns();
+    for (uint32_t it = 0; it < iterations; it++)
+    {
+        for (uint32_t i = 0; i < batch; i++)
+        {
+            memset(&cmd[i], 0, sizeof(pid_cmd_t));
+            cmd[i].index = (it * batch + i) % loops;
+            cmd[i].opcode = PID_CMD_SET_SV;
+            cmd[i].arg[0] = (float)((it + i) % 100);
+        }
+
+        uint64_t t0 = now_ns();
+        if (io_all(fd, req, req_size, 1) ||
+            io_all(fd, &rsp, sizeof(rsp), 0) ||
+            (rsp.magic != PID_CMD_MAGIC) || (rsp.count != batch) ||
+            io_all(fd, result, batch * sizeof(int32_t), 0))
+        {
+            fprintf(stderr, "connection lost\n");
+            return 1;
+        }
+        latency[it] = now_ns() - t0;
+
+        for (uint32_t i = 0; i < batch; i++)
+            failed += (result[i] != PID_OK);
+    }
+    double elapsed = (double)(now_ns() - start) / 1e9;
+
+    qsort(latency, iterations, sizeof(uint64_t), cmp_u64);
+    printf("loops %u, batch %u, iterations %u, failed commands %u\n", loops, batch, iterations, failed);
+    printf("%.0f commands/s, batch latency p50 %.1f us, p99 %.1f us, max %.1f us\n",
+           (double)batch * iterations / elapsed,
+           latency[iterations / 2] / 1e3,
+           latency[(uint64_t)iterations * 99 / 100] / 1e3,
+           latency[iterations - 1] / 1e3);
+
+    close(fd);
+    if (self)
+    {
+        running = 0;
+        pthread_join(server, NULL);
+        pthread_join(tick, NULL);
+        pid_server_destroy(&srv);
+        pid_bank_destroy(&bank);
+    }
+    free(req);
+    free(result);
+    free(latency);
+    return failed ? 2 : 0;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file pid-replay.c
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief replay a recording and check it bit for bit
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * usage: pid-replay <file> [repeat]
+ *        pid-replay --record <file> <samples>
+ *
+ * --record writes a synthetic recording: a first order plant read through the
+ * adc, with a few setpoint and tuning changes, usable as a replay workload.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../pid-record.h"
+#include "../pid-io.h"
+
+static int record(const char *path, uint32_t samples)
+{
+    pid_recorder_t rec;
+    pid_handle_t pid;
+    pid_para_t para;
+    pid_cmd_t cmd;
+    float plant = 0;
+
+    memset(&pid, 0, sizeof(pid));
+    pid_set_default(&pid);
+    memcpy(&para, &pid.parameter, sizeof(para));
+    para.kp = 2.0f;
+    para.ki = 0.5f;
+    para.kd = 0.01f;
+    pid_set_parameter(&pid, &para);
+    pid_set_sample_time(&pid, 0.01f);
+    pid_set_sv_value(&pid, 500.0f);
+    pid_extend_param_cal(&pid);
+    if (pid_arm(&pid) != PID_OK)
+        return 1;
+
+    if (pid_record_open(&rec, path, &pid) != PID_OK)
+        return 1;
+
+    memset(&cmd, 0, sizeof(cmd));
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        if (i % 5000 == 2500)
+        {
+            cmd.opcode = PID_CMD_SET_SV;
+            cmd.arg[0] = (float)(200 + (i / 5000) % 8 * 200);
+            pid_record_apply(&rec, &pid, &cmd);
+        }
+        else if (i % 20000 == 10000)
+        {
+            cmd.opcode = PID_CMD_SET_PARAMETER;
+            cmd.arg[0] = 1.5f + (float)((i / 20000) % 3) * 0.5f;
+            cmd.arg[1] = 0.5f;
+            cmd.arg[2] = 0.01f;
+            pid_record_apply(&rec, &pid, &cmd);
+        }
+
+        // cv [0; 110] (default limits) drives a first order plant in [0; 2000]
+        plant += 0.01f * (pid.control.cv.buff[0] * (2000.0f / 110.0f) - plant);
+        int adc = (int)(plant / 2000.0f * ADC_16IT) + (int)(i * 7919U % 5U) - 2;
+        if (adc < 0)
+            adc = 0;
+        pid_record_process_adc(&rec, &pid, adc);
+    }
+
+    if (pid_record_close(&rec) != PID_OK)
+        return 1;
+    printf("%u samples recorded to %s\n", samples, path);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    pid_replay_t rp;
+    pid_replay_stats_t st;
+    pid_handle_t pid;
+    uint32_t repeat = 1;
+    uint64_t mismatches = 0, elapsed = 0;
+
+    if (argc >= 4 && !strcmp(argv[1], "--record"))
+        return record(argv[2], (uint32_t)strtoul(argv[3], NULL, 0));
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <file> [repeat] | --record <file> <samples>\n", argv[0]);
+        return 1;
+    }
+    if (argc >= 3)
+        repeat = (uint32_t)strtoul(argv[2], NULL, 0);
+
+    if (pid_replay_open(&rp, argv[1]) != PID_OK)
+    {
+        fprintf(stderr, "can not load %s\n", argv[1]);
+        pid_log_drain(stderr);
+        return 1;
+    }
+
+    for (uint32_t r = 0; r < repeat; r++)
+    {
+        pid_replay_run(&rp, &pid, &st);
+        mismatches += st.mismatches;
+        elapsed += st.elapsed_ns;
+        if (st.mismatches && r == 0)
+            printf("first mismatch at entry %llu\n", (unsigned long long)st.first_mismatch);
+    }
+
+    printf("%llu samples, %llu setters, recorded over %.3f s\n",
+           (unsigned long long)st.samples, (unsigned long long)st.setters, st.recorded_us / 1e6);
+    printf("replayed %u times: %llu mismatches, %.1f ns/entry\n", repeat,
+           (unsigned long long)mismatches, rp.count ? (double)elapsed / ((double)rp.count * repeat) : 0.0);
+
+    pid_replay_close(&rp);
+    return mismatches ? 2 : 0;
+}
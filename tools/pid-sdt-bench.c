@@ -0,0 +1,166 @@
+/**
+ * @file pid-sdt-bench.c
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief compression ratio and throughput of the swinging door compressor
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * usage: pid-sdt-bench [channels] [ticks] [pv dev] [cv dev]
+ *
+ * Every channel is a pid loop on a noisy first order plant with setpoint
+ * steps. The pv / sv / cv of every tick are compressed, the first channels
+ * are decompressed and checked against the error bound.
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "../pid-sdt.h"
+
+#define VERIFY_CHANNELS (8U)
+
+typedef struct
+{
+    pid_sdt_point_t *point[VERIFY_CHANNELS][PID_SDT_SIGNAL_MAX];
+    size_t count[VERIFY_CHANNELS][PID_SDT_SIGNAL_MAX];
+    size_t total;
+} sink_t;
+
+static void sink(void *ctx, uint32_t channel, pid_sdt_signal_e signal, const pid_sdt_point_t *point)
+{
+    sink_t *s = (sink_t *)ctx;
+
+    s->total++;
+    if (channel < VERIFY_CHANNELS)
+        s->point[channel][signal][s->count[channel][signal]++] = *point;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t channels = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 4096;
+    uint32_t ticks = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 2000;
+    float dev[PID_SDT_SIGNAL_MAX] = {argc > 3 ? strtof(argv[3], NULL) : 0.5f, 0.0f,
+                                     argc > 4 ? strtof(argv[4], NULL) : 0.1f};
+    uint32_t verify = channels < VERIFY_CHANNELS ? channels : VERIFY_CHANNELS;
+    pid_bank_t bank;
+    pid_sdt_trace_t *trace;
+    float *pv, *plant, *raw[VERIFY_CHANNELS][PID_SDT_SIGNAL_MAX], *rebuilt;
+    uint64_t elapsed = 0, t0;
+    uint32_t seed = 12345;
+    sink_t s;
+
+    if (!channels || !ticks || pid_bank_create(&bank, channels) != PID_OK)
+        return 1;
+
+    trace = (pid_sdt_trace_t *)calloc(channels, sizeof(pid_sdt_trace_t));
+    pv = (float *)calloc(channels, sizeof(float));
+    plant = (float *)calloc(channels, sizeof(float));
+    rebuilt = (float *)malloc(ticks * sizeof(float));
+    memset(&s, 0, sizeof(s));
+    for (uint32_t c = 0; c < verify; c++)
+    {
+        for (int g = 0; g < PID_SDT_SIGNAL_MAX; g++)
+        {
+            s.point[c][g] = (pid_sdt_point_t *)malloc((ticks + 1) * sizeof(pid_sdt_point_t));
+            raw[c][g] = (float *)malloc(ticks * sizeof(float));
+        }
+    }
+
+    for (uint32_t c = 0; c < channels; c++)
+    {
+        pid_handle_t *pid = &bank.pid[c];
+        pid_para_t para;
+
+        memcpy(&para, &pid->parameter, sizeof(para));
+        para.kp = 0.05f;
+        para.ki = 0.5f;
+        para.kd = 0.0f;
+        pid_set_parameter(pid, &para);
+        pid_set_sample_time(pid, 0.01f);
+        pid_extend_param_cal(pid);
+        pid_set_sv_value(pid, 500.0f);
+        pid_arm(pid);
+        pid_sdt_trace_init(&trace[c], dev[PID_SDT_PV], dev[PID_SDT_SV], dev[PID_SDT_CV], 0);
+    }
+
+    for (uint32_t t = 0; t < ticks; t++)
+    {
+        for (uint32_t c = 0; c < channels; c++)
+        {
+            if (t % 500 == 250)
+                pid_set_sv_value(&bank.pid[c], (float)(200 + ((t / 500 + c) % 8) * 200));
+
+            // plant: cv [0; 110] => [0; 2000], noise +/- 0.25
+            seed = seed * 1664525U + 1013904223U;
+            plant[c] += 0.02f * (bank.pid[c].control.cv.buff[0] * (2000.0f / 110.0f) - plant[c]);
+            pv[c] = plant[c] + ((float)(seed >> 8) / 16777216.0f - 0.5f) * 0.5f;
+        }
+        pid_bank_on_processing(&bank, pv);
+
+        t0 = now_ns();
+        pid_sdt_bank_push(trace, &bank, t, sink, &s);
+        elapsed += now_ns() - t0;
+
+        for (uint32_t c = 0; c < verify; c++)
+        {
+            raw[c][PID_SDT_PV][t] = bank.pid[c].control.pv.value;
+            raw[c][PID_SDT_SV][t] = bank.pid[c].control.sv;
+            raw[c][PID_SDT_CV][t] = bank.pid[c].control.cv.buff[0];
+        }
+    }
+    for (uint32_t c = 0; c < channels; c++)
+        pid_sdt_trace_flush(&trace[c], sink, &s, c);
+
+    double samples = (double)channels * ticks * PID_SDT_SIGNAL_MAX;
+    printf("channels %u, ticks %u, dev pv %g sv %g cv %g\n", channels, ticks,
+           dev[PID_SDT_PV], dev[PID_SDT_SV], dev[PID_SDT_CV]);
+    printf("samples %.0f, archived points %zu, ratio %.1f:1, %.1f ns/sample, %.1f M samples/s\n",
+           samples, s.total, samples / (double)s.total, (double)elapsed / samples, samples * 1e3 / (double)elapsed);
+
+    int bad = 0;
+    for (uint32_t c = 0; c < verify; c++)
+    {
+        for (int g = 0; g < PID_SDT_SIGNAL_MAX; g++)
+        {
+            double max_err = 0;
+            pid_sdt_decompress(s.point[c][g], s.count[c][g], 0, rebuilt, ticks);
+            for (uint32_t t = 0; t < ticks; t++)
+                max_err = fmax(max_err, fabs((double)rebuilt[t] - raw[c][g][t]));
+            // bound plus the float rounding of the rebuilt value
+            if (max_err > dev[g] + 1e-6 * (1.0 + fabs(raw[c][g][ticks - 1])) * 4)
+            {
+                printf("channel %u signal %d: max error %g above %g\n", c, g, max_err, dev[g]);
+                bad = 1;
+            }
+        }
+    }
+    printf("error bound %s on %u channels\n", bad ? "VIOLATED" : "verified", verify);
+
+    for (uint32_t c = 0; c < verify; c++)
+    {
+        for (int g = 0; g < PID_SDT_SIGNAL_MAX; g++)
+        {
+            free(s.point[c][g]);
+            free(raw[c][g]);
+        }
+    }
+    free(rebuilt);
+    free(plant);
+    free(pv);
+    free(trace);
+    pid_bank_destroy(&bank);
+    return bad;
+}
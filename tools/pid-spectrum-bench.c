@@ -0,0 +1,163 @@
+/**
+ * @file pid-spectrum-bench.c
+ * @author greatboxs (https://github.com/greatboxs/lw-pid.git)
+ * @brief detection and throughput of the oscillation detector
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * usage: pid-spectrum-bench [loops] [window] [decimation] [cpu]
+ *
+ * Every loop is a pid loop on a noisy first order plant, one loop out of
+ * four gets a sine disturbance on its pv with a period between 8 and 100
+ * ticks. The analysis runs on a pid_rt runner (pinned to cpu if given)
+ * while the loops are ticked, then once more after the last tick: the
+ * flagged loops and the detected periods are checked against the
+ * disturbances inside the analysed band.
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "../pid-bank.h"
+#include "../pid-rt.h"
+#include "../pid-spectrum.h"
+
+#define DISTURBANCE_AMPLITUDE (20.0f)
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static float disturbance_period(uint32_t c)
+{
+    return (c % 4 == 0) ? 8.0f + (float)((c / 4) % 93) : 0.0f;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t loops = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 4096;
+    pid_spectrum_config_t config;
+    pid_rt_config_t rt_config;
+    pid_rt_runner_t runner;
+    pid_spectrum_t sp;
+    pid_bank_t bank;
+    float *pv, *plant;
+    uint64_t push_ns = 0, t0, analyze_ns;
+    uint32_t ticks, seed = 12345;
+    size_t flagged, missed = 0, false_alarm = 0, bad_period = 0, out_of_band = 0;
+    bool runner_started;
+
+    pid_spectrum_config_default(&config);
+    if (argc > 2)
+        config.window = (uint32_t)strtoul(argv[2], NULL, 0);
+    if (argc > 3)
+        config.decimation = (uint32_t)strtoul(argv[3], NULL, 0);
+    config.min_period = 4.0f * config.decimation;
+    config.max_period = 128.0f * config.decimation;
+    config.amplitude = DISTURBANCE_AMPLITUDE / 4;
+
+    if (!loops || pid_bank_create(&bank, loops) != PID_OK)
+        return 1;
+    if (pid_spectrum_create(&sp, &config, loops) != PID_OK)
+    {
+        printf("invalid configuration\n");
+        return 1;
+    }
+
+    pv = (float *)calloc(loops, sizeof(float));
+    plant = (float *)calloc(loops, sizeof(float));
+    for (uint32_t c = 0; c < loops; c++)
+    {
+        pid_handle_t *pid = &bank.pid[c];
+        pid_para_t para;
+
+        memcpy(&para, &pid->parameter, sizeof(para));
+        para.kp = 0.05f;
+        para.ki = 0.5f;
+        para.kd = 0.0f;
+        pid_set_parameter(pid, &para);
+        pid_set_sample_time(pid, 0.01f);
+        pid_extend_param_cal(pid);
+        pid_set_sv_value(pid, 500.0f);
+        pid_arm(pid);
+    }
+
+    pid_rt_config_default(&rt_config, 50000000ULL, pid_spectrum_step, &sp);
+    rt_config.priority = 0;
+    rt_config.cpu = argc > 4 ? atoi(argv[4]) : -1;
+    runner_started = pid_rt_start(&runner, &rt_config) == PID_OK;
+
+    // settle the loops, then fill the window with the disturbances
+    ticks = 3000 + config.window * config.decimation * 2;
+    for (uint32_t t = 0; t < ticks; t++)
+    {
+        for (uint32_t c = 0; c < loops; c++)
+        {
+            float period = disturbance_period(c);
+
+            // plant: cv [0; 110] => [0; 2000], noise +/- 0.25
+            seed = seed * 1664525U + 1013904223U;
+            plant[c] += 0.02f * (bank.pid[c].control.cv.buff[0] * (2000.0f / 110.0f) - plant[c]);
+            pv[c] = plant[c] + ((float)(seed >> 8) / 16777216.0f - 0.5f) * 0.5f;
+            if ((period > 0) && (t >= 3000))
+                pv[c] += DISTURBANCE_AMPLITUDE * sinf(2.0f * (float)M_PI * (float)t / period);
+        }
+        pid_bank_on_processing(&bank, pv);
+
+        t0 = now_ns();
+        pid_spectrum_push_bank(&sp, bank.pid, bank.count);
+        push_ns += now_ns() - t0;
+    }
+
+    if (runner_started)
+        pid_rt_stop(&runner);
+
+    t0 = now_ns();
+    flagged = pid_spectrum_analyze(&sp, 0, loops);
+    analyze_ns = now_ns() - t0;
+
+    for (uint32_t c = 0; c < loops; c++)
+    {
+        pid_spectrum_result_t res;
+        float period = disturbance_period(c);
+
+        pid_spectrum_get(&sp, c, &res);
+        if ((period > 0) && (period < config.min_period))
+            out_of_band++; // faster than the analysed band, not checked
+        else if ((period > 0) && !res.oscillating)
+            missed++;
+        else if ((period == 0) && res.oscillating)
+            false_alarm++;
+        else if ((period > 0) && (fabsf(res.period - period) > 0.05f * period))
+            bad_period++;
+        if (c < 8)
+            printf("loop %u: disturbance %5.1f, detected %5.1f ticks, e %6.2f, u %6.2f, ratio %.2f%s\n",
+                   c, period, res.period, res.err_amp, res.cv_amp, res.ratio, res.oscillating ? " OSCILLATING" : "");
+    }
+
+    printf("loops %u, window %u, decimation %u, bins %u, memory %zu bytes/loop\n", loops, config.window,
+           config.decimation, sp.bins, 2 * config.window * sizeof(float) + sizeof(pid_spectrum_result_t) +
+                                            sizeof(uint32_t) + (config.decimation > 1 ? 2 * sizeof(float) : 0));
+    printf("push %.1f ns/loop/tick, analysis %.2f us/loop, %.0f loops/s on one core\n",
+           (double)push_ns / ((double)ticks * loops), (double)analyze_ns / (1e3 * loops),
+           (double)loops * 1e9 / (double)analyze_ns);
+    if (runner_started)
+        printf("background passes during the run: %lu\n", (unsigned long)sp.passes);
+    printf("flagged %zu, missed %zu, false alarms %zu, period errors > 5%% %zu, out of band %zu\n",
+           flagged, missed, false_alarm, bad_period, out_of_band);
+
+    free(plant);
+    free(pv);
+    pid_spectrum_destroy(&sp);
+    pid_bank_destroy(&bank);
+    return (missed || false_alarm || bad_period) ? 1 : 0;
+}